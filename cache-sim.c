@@ -20,57 +20,277 @@
  */
 
 #include "cache-sim.h"
+#include "dram.h"
+#include "libcachesim.h"
+#include "locality.h"
+#include "memo.h"
+#include "profile.h"
+#include "shared.h"
+#include "synthetic.h"
+#include "trace.h"
+#include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
-int isPowerOfTwo(int n);
 int getAssociativity(char *cacheAssociativity);
-void printCounters(int totalInstructions, int memoryReads, int memoryWrites, int l1CacheHits, int l1CacheMisses, float l1MissRate, int l2CacheHits, int l2CacheMisses, float l2MissRate, float overallMissRate);
-int logBase2(int n);
-unsigned long long int getTag(unsigned long long int address, int setBits, int tagBits, int blockOffset);
-unsigned long int getSet(unsigned long long int address, int setBits, int tagBits, int blockOffset);
-int fetch(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set, int numLines, int numSets);
-void updateLRU(Cache *cache, int tagIndex, int setIndex, int numLines);
-int evict(Cache *cache, unsigned long long int tag, int setIndex, int numLines);
-void printCache(Cache *cache, int numSets, int numLines);
+int parseAssociativity(char *cacheAssociativity, const char *name, int *associativity);
+int parseTlbs(const char *spec, CacheSimConfig *config);
+int parsePageSize(const char *pageSize);
+int parseDram(const char *spec, CacheSimDramConfig *dram);
+int parseIndexFunction(const char *name);
+int parseList(const char *list, int *values, int maxValues);
+int parsePartition(const char *spec, int *partition, int *ways, int *numWays, unsigned long int *interval);
+int simulateTenants(const CacheSimConfig *config, char **tenantSpecs, int numTenants, const int *weights, int traceFormat,
+                    const char *partitionSpec, unsigned long long int skipRecords, unsigned long long int limitRecords,
+                    int readahead);
+void printStats(const CacheSimStats *stats, const CacheSimConfig *config, int tlb);
+void printCounters(const CacheSimCounters *counters, const CacheSimConfig *config);
+void printTlbCounters(const CacheSimTlbCounters *counters);
+void printDramCounters(const CacheSimDramCounters *counters, const CacheSimConfig *config, unsigned long long int accesses);
 void printUsage();
 
+/* What main does with the trace */
+#define MODE_SIMULATE 0
+/* Simulate L1 only and write its misses out as a reduced trace */
+#define MODE_FILTER_L1 1
+/* Simulate L2 only, from a reduced trace written by MODE_FILTER_L1 */
+#define MODE_L2_ONLY 2
+
 int main(int argc, char *argv[])
 {
     /* Maintain a cache simulator.
-     * The Cache contains a hash table of Sets.
-     * A Set contains a hash table of Lines.
-     * A Line contains information about the validity of the current block, the tag, and the block itself.
-     * Assume all addresses will be 48 bits.
-     * To index:
-     * The Block Offset (number of bits) is given by log2(cacheBlockSize); discard these bits on the right
-     * The Set bits are given by log2(cacheAssociativityN); use these bits on the left
-     * The Tag (number of bits) is given by the number of bits in the address (48) - Block Offset bits - Set bits
+     * The simulation engine lives in libcachesim; main parses the command line,
+     * reads the trace file and reports the counters.
+     * See libcachesim.c for how each Cache is indexed.
      */
 
     /* The total size of the caches in bytes; should be a power of 2 */
     int l1CacheSize;
     int l2CacheSize;
-    /* The associativity of the caches; either direct (1), accoc (2), or assoc:n (3);
+    /* The associativity of the caches; either direct, assoc, or assoc:n;
      * n should be a power of 2 */
-    char *l1CacheAssociativity; int l1CacheAssociativityType = 0, l1CacheAssociativityN = 1;
-    char *l2CacheAssociativity; int l2CacheAssociativityType = 0, l2CacheAssociativityN = 1;
+    char *l1CacheAssociativity;
+    char *l2CacheAssociativity;
     /* The cache policies for eviction (always lru) */
     char *l1CachePolicy;
     char *l2CachePolicy;
     /* The size of the cache blocks in bytes; should be a power of 2 */
     int l1CacheBlockSize;
     int l2CacheBlockSize;
-    /* The name of the trace file */
-    char *traceFile; FILE *traceFP;
+    /* The name of the trace file ("-" for standard input), and its format */
+    char *traceFile; TraceReader *trace;
+    int traceFormat = TRACE_TEXT;
+    /* A synthetic workload to simulate instead of a trace file */
+    char *generatorSpec = 0;
+    /* The window of trace records to simulate */
+    unsigned long long int skipRecords = 0, limitRecords = 0;
+    /* Read trace files ahead on a background thread */
+    int readahead = 1;
+    /* Self-profiling: 0 off, 1 phase timers, 2 also hardware counters */
+    int profiling = 0;
+    /* L1 miss filtering */
+    int mode = MODE_SIMULATE;
+    char *filterFile = 0; TraceWriter *filter = 0;
+    /* Set index functions */
+    int l1IndexFunction = CACHESIM_INDEX_MODULO, l2IndexFunction = CACHESIM_INDEX_MODULO;
+    /* Victim or miss caches: the number of entries beside each level */
+    int l1VictimEntries = 0, l2VictimEntries = 0, l1MissCache = 0, l2MissCache = 0;
+    /* Sectors per block of each level; 0 for whole blocks */
+    int l1Sectors = 0, l2Sectors = 0;
+    /* Co-scheduled traces sharing L2: each tenant's trace (or gen:spec), its accesses per turn and the partitioning */
+    char *tenantSpecs[SHARED_MAX_TENANTS];
+    int numTenants = 0;
+    int weights[SHARED_MAX_TENANTS];
+    char *weightSpec = 0, *partitionSpec = 0;
+    /* Directory of memoized results */
+    char *memoDir = 0;
+    char memoKey[512];
+    /* Back large caches with huge pages */
+    int hugePages = 0;
+    /* TLB model: "dtlb,itlb,l2" sizes as entries:ways, the page size and whether walks touch the caches */
+    char *tlbSpec = 0;
+    int pageSize = 4096, pageWalks = 0;
+    /* DRAM model: "channels:banks[:row_bytes[:burst_bytes]]", and the accesses per bandwidth interval */
+    char *dramSpec = 0;
+    unsigned long int dramInterval = DRAM_DEFAULT_INTERVAL;
+    /* Locality analysis options */
+    int reuseHistograms = 0;
+    unsigned int reuseWindow = REUSE_DEFAULT_WINDOW;
+    char *workingSetFile = 0; FILE *workingSetFP = 0;
+    unsigned long int workingSetInterval = WSS_DEFAULT_INTERVAL;
+
+    /* Options may appear anywhere; the remaining arguments are positional */
+    static struct option longOptions[] =
+    {
+        {"lackey", no_argument, 0, 'l'},
+        {"generate", required_argument, 0, 'g'},
+        {"huge-pages", no_argument, 0, 'H'},
+        {"l1-index", required_argument, 0, 'i'},
+        {"l2-index", required_argument, 0, 'I'},
+        {"l1-victim", required_argument, 0, 'v'},
+        {"l2-victim", required_argument, 0, 'V'},
+        {"l1-miss-cache", required_argument, 0, 'm'},
+        {"l2-miss-cache", required_argument, 0, 'M'},
+        {"l1-sectors", required_argument, 0, 'c'},
+        {"l2-sectors", required_argument, 0, 'C'},
+        {"tenant", required_argument, 0, 'T'},
+        {"weights", required_argument, 0, 'e'},
+        {"partition", required_argument, 0, 'a'},
+        {"memo", required_argument, 0, 'o'},
+        {"tlb", required_argument, 0, 't'},
+        {"page-size", required_argument, 0, 'P'},
+        {"page-walks", no_argument, 0, 'p'},
+        {"dram", required_argument, 0, 'D'},
+        {"dram-interval", required_argument, 0, 'd'},
+        {"filter-l1", required_argument, 0, 'f'},
+        {"l2-only", no_argument, 0, '2'},
+        {"skip", required_argument, 0, 's'},
+        {"limit", required_argument, 0, 'n'},
+        {"no-readahead", no_argument, 0, 'N'},
+        {"profile", optional_argument, 0, 'F'},
+        {"reuse", no_argument, 0, 'r'},
+        {"reuse-window", required_argument, 0, 'R'},
+        {"wss", required_argument, 0, 'w'},
+        {"wss-interval", required_argument, 0, 'W'},
+        {0, 0, 0, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "", longOptions, 0)) != -1)
+    {
+        switch (option)
+        {
+            case 'l':
+                traceFormat = TRACE_LACKEY;
+                break;
+            case 'g':
+                generatorSpec = optarg;
+                break;
+            case 'H':
+                hugePages = 1;
+                break;
+            case 'i':
+                l1IndexFunction = parseIndexFunction(optarg);
+                break;
+            case 'I':
+                l2IndexFunction = parseIndexFunction(optarg);
+                break;
+            case 'v':
+                l1VictimEntries = atoi(optarg);
+                l1MissCache = 0;
+                break;
+            case 'V':
+                l2VictimEntries = atoi(optarg);
+                l2MissCache = 0;
+                break;
+            case 'm':
+                l1VictimEntries = atoi(optarg);
+                l1MissCache = 1;
+                break;
+            case 'M':
+                l2VictimEntries = atoi(optarg);
+                l2MissCache = 1;
+                break;
+            case 'c':
+                l1Sectors = atoi(optarg);
+                break;
+            case 'C':
+                l2Sectors = atoi(optarg);
+                break;
+            case 'T':
+                if (numTenants == SHARED_MAX_TENANTS)
+                {
+                    printf("Error: at most %d tenants can share L2.\n", SHARED_MAX_TENANTS);
+                    return -1;
+                }
+                tenantSpecs[numTenants++] = optarg;
+                break;
+            case 'e':
+                weightSpec = optarg;
+                break;
+            case 'a':
+                partitionSpec = optarg;
+                break;
+            case 'o':
+                memoDir = optarg;
+                break;
+            case 't':
+                tlbSpec = optarg;
+                break;
+            case 'P':
+                pageSize = parsePageSize(optarg);
+                break;
+            case 'p':
+                pageWalks = 1;
+                break;
+            case 'D':
+                dramSpec = optarg;
+                break;
+            case 'd':
+                dramInterval = strtoul(optarg, 0, 10);
+                break;
+            case 'f':
+                mode = MODE_FILTER_L1;
+                filterFile = optarg;
+                break;
+            case '2':
+                mode = MODE_L2_ONLY;
+                break;
+            case 's':
+                skipRecords = strtoull(optarg, 0, 10);
+                break;
+            case 'n':
+                limitRecords = strtoull(optarg, 0, 10);
+                break;
+            case 'N':
+                readahead = 0;
+                break;
+            case 'F':
+                if (optarg && strcmp(optarg, "perf"))
+                {
+                    printf("Error: --profile takes no value or \"perf\".\n");
+                    return -1;
+                }
+                profiling = optarg ? 2 : 1;
+                break;
+            case 'r':
+                reuseHistograms = 1;
+                break;
+            case 'R':
+            {
+                /* The tracker's window holds twice the blocks asked for */
+                char *end;
+                unsigned long int blocks = strtoul(optarg, &end, 10);
+                if (end == optarg || *end != '\0' || blocks == 0 || blocks > REUSE_MAX_WINDOW / 2)
+                {
+                    printf("Error: --reuse-window takes a number of blocks from 1 to %d.\n", REUSE_MAX_WINDOW / 2);
+                    return -1;
+                }
+                reuseHistograms = 1;
+                reuseWindow = 2 * blocks;
+                break;
+            }
+            case 'w':
+                workingSetFile = optarg;
+                break;
+            case 'W':
+                workingSetInterval = strtoul(optarg, 0, 10);
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
 
-    if (argc != 10)
+    /* A generated workload, or the tenants' traces, take the place of the trace file */
+    if (argc - optind != ((generatorSpec || numTenants) ? 8 : 9))
     {
         printf("Error: invalid number of arguments.\n");
         printUsage();
         return -1;
     }
+    argv += optind - 1;
 
     /* Assume argv[1] is an int representing the L1 cache size */
     l1CacheSize = atoi(argv[1]);
@@ -89,560 +309,511 @@ int main(int argc, char *argv[])
     /* Assume argv[8] is an int representing the L2 cache block size */
     l2CacheBlockSize = atoi(argv[8]);
     /* Assume argv[9] is a string representing the name of the trace file */
-    traceFile = argv[9];
+    traceFile = (generatorSpec || numTenants) ? 0 : argv[9];
 
     /* Error Checking: */
+    CacheSimConfig config;
+    memset(&config, 0, sizeof(CacheSimConfig));
+    config.l1.size = l1CacheSize;
+    config.l1.blockSize = l1CacheBlockSize;
+    config.l2.size = l2CacheSize;
+    config.l2.blockSize = l2CacheBlockSize;
+    config.l1.indexFunction = l1IndexFunction;
+    config.l2.indexFunction = l2IndexFunction;
+    config.l1.victimEntries = l1VictimEntries;
+    config.l1.missCache = l1MissCache;
+    config.l2.victimEntries = l2VictimEntries;
+    config.l2.missCache = l2MissCache;
+    config.l1.sectors = l1Sectors;
+    config.l2.sectors = l2Sectors;
+    config.hugePages = hugePages;
+    config.pageSize = pageSize;
+    config.pageWalks = pageWalks;
+
+    /* TLBs */
+    if (tlbSpec && parseTlbs(tlbSpec, &config))
+    {
+        printf("Error: improperly formatted TLB sizes; expected dtlb_entries:ways,itlb_entries:ways,l2_entries:ways.\n");
+        return -1;
+    }
+    if (tlbSpec && mode != MODE_SIMULATE)
+    {
+        printf("Error: --tlb applies to full simulations, not to --filter-l1 or --l2-only.\n");
+        return -1;
+    }
 
-    /* Cache Size */
-    /* Must be a positive power of 2 */
-    if (l1CacheSize <= 0 || !isPowerOfTwo(l1CacheSize))
+    /* DRAM */
+    if (dramSpec && parseDram(dramSpec, &config.dram))
     {
-        printf("Error: L1 cache size must be a power of 2.\n");
+        printf("Error: improperly formatted DRAM geometry; expected channels:banks[:row_bytes[:burst_bytes]].\n");
         return -1;
     }
-    if (l2CacheSize <= 0 || !isPowerOfTwo(l2CacheSize))
+    if (dramSpec)
     {
-        printf("Error: L2 cache size must be a power of 2.\n");
+        config.dram.interval = dramInterval;
+    }
+    /* A filtered trace leaves out the writes that hit L1, and with them their DRAM traffic */
+    if (dramSpec && mode != MODE_SIMULATE)
+    {
+        printf("Error: --dram applies to full simulations, not to --filter-l1 or --l2-only.\n");
+        return -1;
+    }
+
+    /* The filtered trace records L1 hits and misses, not what an L1 victim cache saved */
+    if (l1VictimEntries && mode != MODE_SIMULATE)
+    {
+        printf("Error: an L1 victim or miss cache applies to full simulations, not to --filter-l1 or --l2-only.\n");
         return -1;
     }
 
     /* Associativity */
-    /* Either direct, assoc, or assoc:n, where n is a positive power of 2 */
-    /* If cache is direct (strcmp returns 0 if strings are equal), cache is direct (1) */
-    if (!strcmp(l1CacheAssociativity, "direct"))
+    if (parseAssociativity(l1CacheAssociativity, "L1", &config.l1.associativity) ||
+        parseAssociativity(l2CacheAssociativity, "L2", &config.l2.associativity))
     {
-        l1CacheAssociativityType = 1;
+        return -1;
     }
-    /* Otherwise, determine the associativity */
-    else
+
+    /* Cache Policy */
+    /* Only valid policy is lru (least recently used) */
+    if (strcmp(l1CachePolicy, "lru"))
     {
-        /* Get the associativity */
-        int l1CacheAssociativityResult = getAssociativity(l1CacheAssociativity);
+        printf("Error: invalid L1 cache replacement policy.\n");
+        return -1;
+    }
+    if (strcmp(l2CachePolicy, "lru"))
+    {
+        printf("Error: invalid L2 cache replacement policy.\n");
+        return -1;
+    }
 
-        /* If cacheAssociativityResult is 0, cache is fully associative (2) */
-        if (l1CacheAssociativityResult == 0)
+    /* Cache Size, Block Size */
+    char error[128];
+    if (cacheSimCheckConfig(&config, error, sizeof(error)))
+    {
+        printf("Error: %s\n", error);
+        return -1;
+    }
+
+    /* Co-scheduled tenants run on their own path */
+    if ((weightSpec || partitionSpec) && numTenants == 0)
+    {
+        printf("Error: --weights and --partition apply to --tenant traces.\n");
+        return -1;
+    }
+    if (numTenants)
+    {
+        if (generatorSpec || tlbSpec || dramSpec || mode != MODE_SIMULATE || reuseHistograms || workingSetFile || profiling)
         {
-            l1CacheAssociativityType = 2;
-            l1CacheAssociativityN = l1CacheSize / l1CacheBlockSize;
+            printf("Error: --tenant cannot be combined with --generate, --tlb, --dram, --filter-l1, --l2-only, --reuse, --wss or --profile.\n");
+            return -1;
         }
-
-        /* If cacheAssociativtyResult is positive, cache is n-way associative (3) */
-        if (l1CacheAssociativityResult > 0)
+        /* Round robin, one access each per turn, unless weighted */
+        int i;
+        for (i = 0; i < numTenants; i++)
         {
-            l1CacheAssociativityType = 3;
-            l1CacheAssociativityN = l1CacheAssociativityResult;
+            weights[i] = 1;
         }
-
-        /* If cacheAssociativityResult is -1, error */
-        if (l1CacheAssociativityResult < 0)
+        if (weightSpec && parseList(weightSpec, weights, numTenants) != numTenants)
         {
-            printf("Error: invalid L1 cache associativity.\n");
+            printf("Error: --weights needs one positive weight per tenant.\n");
             return -1;
         }
+        return simulateTenants(&config, tenantSpecs, numTenants, weights, traceFormat, partitionSpec, skipRecords, limitRecords,
+                               readahead);
     }
 
-    if (!strcmp(l2CacheAssociativity, "direct"))
+    /* Memoized results: a full simulation already run on the same trace content and
+     * configuration prints its stored counters. A trace on standard input is simulated as usual */
+    if (memoDir && (mode != MODE_SIMULATE || reuseHistograms || workingSetFile))
     {
-        l2CacheAssociativityType = 1;
+        printf("Error: --memo applies to full simulations, not to --filter-l1, --l2-only, --reuse or --wss.\n");
+        return -1;
     }
-    /* Otherwise, determine the associativity */
-    else
+    if (memoDir && !generatorSpec && !strcmp(traceFile, "-"))
     {
-        /* Get the associativity */
-        int l2CacheAssociativityResult = getAssociativity(l2CacheAssociativity);
-
-        /* If cacheAssociativityResult is 0, cache is fully associative (2) */
-        if (l2CacheAssociativityResult == 0)
+        memoDir = 0;
+    }
+    if (memoDir)
+    {
+        char traceDigest[MEMO_DIGEST_LENGTH];
+        if (openMemo(memoDir))
+        {
+            printf("Error: could not create memo directory %s.\n", memoDir);
+            return -1;
+        }
+        if (generatorSpec)
         {
-            l2CacheAssociativityType = 2;
-            l2CacheAssociativityN = l2CacheSize / l2CacheBlockSize;
+            digestBytes(generatorSpec, strlen(generatorSpec), traceDigest);
         }
+        else if (digestTrace(memoDir, traceFile, traceDigest))
+        {
+            printf("Error: trace file not found.\n");
+            return -1;
+        }
+        makeMemoKey(memoKey, sizeof(memoKey), traceDigest, &config, generatorSpec ? TRACE_SYNTHETIC : traceFormat,
+                    skipRecords, limitRecords);
 
-        /* If cacheAssociativtyResult is positive, cache is n-way associative (3) */
-        if (l2CacheAssociativityResult > 0)
+        CacheSimStats stats;
+        if (loadMemo(memoDir, memoKey, &stats))
         {
-            l2CacheAssociativityType = 3;
-            l2CacheAssociativityN = l2CacheAssociativityResult;
+            printStats(&stats, &config, tlbSpec != 0);
+            return 0;
         }
+    }
 
-        /* If cacheAssociativityResult is -1, error */
-        if (l2CacheAssociativityResult < 0)
+    /* Trace File, or synthetic workload */
+    if (generatorSpec)
+    {
+        if (mode == MODE_L2_ONLY)
         {
-            printf("Error: invalid L2 cache associativity.\n");
+            printf("Error: --l2-only needs a trace written by --filter-l1.\n");
             return -1;
         }
+        SyntheticGenerator *generator = createGenerator(generatorSpec, error, sizeof(error));
+        if (generator == 0)
+        {
+            printf("Error: %s\n", error);
+            return -1;
+        }
+        trace = openSyntheticTrace(generator);
     }
-
-    /* Cache Policy */
-    /* Only valid policy is lru (least recently used) */
-    if (strcmp(l1CachePolicy, "lru"))
+    else
     {
-        printf("Error: invalid L1 cache replacement policy.\n");
-        return -1;
+        trace = openTrace(traceFile, traceFormat);
     }
-    if (strcmp(l2CachePolicy, "lru"))
+    /* openTrace returns 0, the NULL pointer, on failure */
+    if (trace == 0)
     {
-        printf("Error: invalid L2 cache replacement policy.\n");
+        printf("Error: trace file not found.\n");
         return -1;
     }
-
-    /* Block Size */
-    /* Must be a positive power of 2, less than or equal to the cache size */
-    if (l1CacheBlockSize > l1CacheSize || !isPowerOfTwo(l1CacheBlockSize))
+    /* An access that straddles L1 blocks touches each of them */
+    trace -> splitBlockSize = l1CacheBlockSize;
+    /* Runs of accesses to one L1 block are simulated once, and the rest counted as L1 hits,
+     * unless the TLBs, DRAM or the locality trackers need to see each access */
+    if (mode != MODE_L2_ONLY && !tlbSpec && !dramSpec && !reuseHistograms && !workingSetFile)
+    {
+        /* In a sectored L1, only accesses to one sector are sure to hit */
+        trace -> coalesceBlockSize = l1Sectors > 1 ? l1CacheBlockSize / l1Sectors : l1CacheBlockSize;
+    }
+    /* Sample window */
+    if (skipRecords && seekTrace(trace, skipRecords))
     {
-        printf("Error: L1 block size must be a positive power of 2, <= to L1 cache size.\n");
+        printf("Error: trace has fewer than %llu records.\n", skipRecords);
+        closeTrace(trace);
         return -1;
     }
-    if (l2CacheBlockSize > l2CacheSize || !isPowerOfTwo(l2CacheBlockSize))
+    if (limitRecords)
     {
-        printf("Error: L2 block size must be a positive power of 2, <= to L2 cache size.\n");
+        trace -> recordLimit = skipRecords + limitRecords;
+    }
+    /* The L1 counters stored with a filtered trace cover all of it */
+    if (mode == MODE_L2_ONLY && (skipRecords || limitRecords))
+    {
+        printf("Error: --l2-only simulates the whole filtered trace; --skip and --limit apply when filtering.\n");
+        closeTrace(trace);
         return -1;
     }
-
-    /* Trace File */
-    traceFP = fopen(traceFile, "r");
-    /* fopen returns 0, the NULL pointer, on failure */
-    if (traceFP == 0)
+    if (readahead && startTraceReadahead(trace))
     {
-        printf("Error: trace file not found.\n");
+        printf("Error: could not start the trace readahead thread.\n");
+        closeTrace(trace);
         return -1;
     }
 
-    /* Create Cache Models */
-    /* Assume addresses are 48 bits */
-    int addressLength = 48;
-    /* Determine the number of bits for the Block Offset */
-    int l1BlockOffsetBits = logBase2(l1CacheBlockSize);
-    int l2BlockOffsetBits = logBase2(l2CacheBlockSize);
-    /* Determine the number of Lines per Set */
-    int l1NumLines = l1CacheAssociativityN;
-    int l2NumLines = l2CacheAssociativityN;
-    /* Determine the number of Sets in the Cache */
-    int l1NumSets = l1CacheSize / (l1CacheBlockSize * l1NumLines);
-    int l2NumSets = l2CacheSize / (l2CacheBlockSize * l2NumLines);
-    /* Determine the number of bits for the Set */
-    int l1SetBits = logBase2(l1NumSets);
-    int l2SetBits = logBase2(l2NumSets);
-    /* Determine the number of bits for the Tag */
-    int l1TagBits = addressLength - l1BlockOffsetBits - l1SetBits;
-    int l2TagBits = addressLength - l2BlockOffsetBits - l2SetBits;
-
-    /* Allocate the Cache structs */
-    Cache *l1NoPrefetchCache = (Cache *) malloc(sizeof(Cache));
-    Cache *l1WithPrefetchCache = (Cache *) malloc(sizeof(Cache));
-    l1NoPrefetchCache -> size = l1CacheSize;
-    l1WithPrefetchCache -> size = l1CacheSize;
-    l1NoPrefetchCache -> blockSize = l1CacheBlockSize;
-    l1WithPrefetchCache -> blockSize = l1CacheBlockSize;
-    l1NoPrefetchCache -> associativity = l1CacheAssociativityType;
-    l1WithPrefetchCache -> associativity = l1CacheAssociativityType;
-    l1NoPrefetchCache -> nSets = l1CacheAssociativityN;
-    l1WithPrefetchCache -> nSets = l1CacheAssociativityN;
-
-    Cache *l2NoPrefetchCache = (Cache *) malloc(sizeof(Cache));
-    Cache *l2WithPrefetchCache = (Cache *) malloc(sizeof(Cache));
-    l2NoPrefetchCache -> size = l2CacheSize;
-    l2WithPrefetchCache -> size = l2CacheSize;
-    l2NoPrefetchCache -> blockSize = l2CacheBlockSize;
-    l2WithPrefetchCache -> blockSize = l2CacheBlockSize;
-    l2NoPrefetchCache -> associativity = l2CacheAssociativityType;
-    l2WithPrefetchCache -> associativity = l2CacheAssociativityType;
-    l2NoPrefetchCache -> nSets = l2CacheAssociativityN;
-    l2WithPrefetchCache -> nSets = l2CacheAssociativityN;
-
-    /* Allocate the Caches' hash table of Sets */
-    l1NoPrefetchCache -> sets = (Set *) malloc(l1NumSets * sizeof(Set));
-    l1WithPrefetchCache -> sets = (Set *) malloc(l1NumSets * sizeof(Set));
-
-    l2NoPrefetchCache -> sets = (Set *) malloc(l2NumSets * sizeof(Set));
-    l2WithPrefetchCache -> sets = (Set *) malloc(l2NumSets * sizeof(Set));
-
-    /* Allocate each Set's Lines */
-    int i, j;
-    for (i = 0; i < l1NumSets; i++)
-    {
-        l1NoPrefetchCache -> sets[i].lines = (Line *) malloc(l1NumLines * sizeof(Line));
-        l1WithPrefetchCache -> sets[i].lines = (Line *) malloc(l1NumLines * sizeof(Line));
-        l1NoPrefetchCache -> sets[i].numItems = 0;
-        l1WithPrefetchCache -> sets[i].numItems = 0;
-
-        /* Initialize each Line */
-        for (j = 0; j < l1NumLines; j++)
-        {
-            l1NoPrefetchCache -> sets[i].lines[j].valid = 0;
-            l1WithPrefetchCache -> sets[i].lines[j].valid = 0;
-            l1NoPrefetchCache -> sets[i].lines[j].usage = 0;
-            l1WithPrefetchCache -> sets[i].lines[j].usage = 0;
-        }
-    }
-    for (i = 0; i < l2NumSets; i++)
-    {
-        l2NoPrefetchCache -> sets[i].lines = (Line *) malloc(l2NumLines * sizeof(Line));
-        l2WithPrefetchCache -> sets[i].lines = (Line *) malloc(l2NumLines * sizeof(Line));
-        l2NoPrefetchCache -> sets[i].numItems = 0;
-        l2WithPrefetchCache -> sets[i].numItems = 0;
-
-        /* Initialize each Line */
-        for (j = 0; j < l2NumLines; j++)
-        {
-            l2NoPrefetchCache -> sets[i].lines[j].valid = 0;
-            l2WithPrefetchCache -> sets[i].lines[j].valid = 0;
-            l2NoPrefetchCache -> sets[i].lines[j].usage = 0;
-            l2WithPrefetchCache -> sets[i].lines[j].usage = 0;
+    /* Filtered Trace; a .cst file name selects the compressed format */
+    if (filterFile)
+    {
+        size_t length = strlen(filterFile);
+        int filterFormat = (length > 4 && !strcmp(filterFile + length - 4, ".cst")) ? TRACE_COMPRESSED : TRACE_TEXT;
+        filter = createTraceWriter(filterFile, filterFormat);
+        if (filter == 0)
+        {
+            printf("Error: could not open filtered trace file.\n");
+            closeTrace(trace);
+            return -1;
         }
     }
 
-    /* Simulation */
-    int totalInstructions = 0;
-
-    /* Establish no-prefetch counters */
-    /* The number of reads from memory */
-    int noPrefetchMemoryReads = 0;
-    /* The number of writes to memory */
-    int noPrefetchMemoryWrites = 0;
-    /* The number of cache hits */
-    int l1NoPrefetchCacheHits = 0;
-    int l2NoPrefetchCacheHits = 0;
-    /* The number of cache misses */
-    int l1NoPrefetchCacheMisses = 0;
-    int l2NoPrefetchCacheMisses = 0;
-
-    /* Establish with-prefetch counters */
-    /* The number of reads from memory */
-    int withPrefetchMemoryReads = 0;
-    /* The number of writes to memory */
-    int withPrefetchMemoryWrites = 0;
-    /* The number of cache hits */
-    int l1WithPrefetchCacheHits = 0;
-    int l2WithPrefetchCacheHits = 0;
-    /* The number of cache misses */
-    int l1WithPrefetchCacheMisses = 0;
-    int l2WithPrefetchCacheMisses = 0;
-
-    /* Read in each line from the trace file, until the end */
-    char line[100];
-    long int instruction;
-    char operation;
-    unsigned long long int address = 0;
-    unsigned long long int l1AddressTag = 0;
-    unsigned long long int l2AddressTag = 0;
-    unsigned long int l1AddressSet = 0;
-    unsigned long int l2AddressSet = 0;
-    int hit = 0;
-    unsigned long int count = 0;
-
-    fscanf(traceFP, "%99[^\n]", line);
-    getc(traceFP);
-    while (strcmp(line, "#eof"))
-    {
-        sscanf(line, "%lx: %c %llx\n", &instruction, &operation, &address);
-        
-        count++;
-
-        /* Get the Tag and the Set from the Address */
-        l1AddressTag = getTag(address, l1SetBits, l1TagBits, l1BlockOffsetBits);
-        l1AddressSet = getSet(address, l1SetBits, l1TagBits, l1BlockOffsetBits);
-
-        totalInstructions++;
-        
-        /*
-        printf("Instruction: %s\n", line);
-        printf("Set: %lu, NumSets: %d, SetIndex: %d\n", addressSet, numSets, hash(addressSet, numSets));
-        printf("Tag: %llx, NumLines: %d, TagIndex: %d\n", addressTag, numLines, hash(addressTag, numLines));
-        */
-
-        /* If operation is a Read */
-        if (operation == 'R')
-        {
-            /* Read Without Prefetching */
-            /* Check L1 cache */
-            hit = fetch(l1NoPrefetchCache, 0, l1AddressTag, l1AddressSet, l1NumLines, l1NumSets);
-
-            /* If L1 Cache Hit */
-            if (hit)
+    /* Working Set Curve */
+    if (workingSetFile)
+    {
+        workingSetFP = fopen(workingSetFile, "w");
+        if (workingSetFP == 0)
+        {
+            printf("Error: could not open working set file.\n");
+            /* Stop the readahead thread; the trackers are not created yet */
+            if (filter)
             {
-                l1NoPrefetchCacheHits++;
+                closeTraceWriter(filter);
             }
-            /* If L1 Cache Miss */
-            else
-            {
-                l1NoPrefetchCacheMisses++;
-
-                /* Check L2 cache */
-                l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
+            closeTrace(trace);
+            return -1;
+        }
+    }
 
-                hit = fetch(l2NoPrefetchCache, 0, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
+    /* Create the Cache hierarchy */
+    CacheSim *sim = cacheSimCreate(&config);
+    if (sim == 0)
+    {
+        printf("Error: could not allocate the caches.\n");
+        if (filter)
+        {
+            closeTraceWriter(filter);
+        }
+        if (workingSetFP)
+        {
+            fclose(workingSetFP);
+        }
+        closeTrace(trace);
+        return -1;
+    }
 
-                /* If L2 Cache Hit */
-                if (hit)
-                {
-                    l2NoPrefetchCacheHits++;
-                }
-                /* If L2 Cache Miss */
-                else
-                {
-                    l2NoPrefetchCacheMisses++;
-                    noPrefetchMemoryReads++;
-                }
-            }
+    /* Locality trackers: L1 sees every access, L2 sees the no-prefetch L1 misses */
+    ReuseTracker *l1Reuse = 0, *l2Reuse = 0;
+    WorkingSetTracker *workingSet = 0;
+    if (reuseHistograms)
+    {
+        /* A filtered trace holds only what reaches L2 */
+        if (mode != MODE_L2_ONLY)
+        {
+            l1Reuse = createReuseTracker(l1CacheBlockSize, reuseWindow);
+        }
+        l2Reuse = createReuseTracker(l2CacheBlockSize, reuseWindow);
+    }
+    if (workingSetFP)
+    {
+        workingSet = createWorkingSetTracker(l1CacheBlockSize, workingSetInterval, workingSetFP);
+    }
+    CacheSimProfile *profile = 0;
+    if (profiling)
+    {
+        profile = createProfile(profiling == 2);
+    }
+    if ((reuseHistograms && (l2Reuse == 0 || (mode != MODE_L2_ONLY && l1Reuse == 0))) || (workingSetFP && workingSet == 0) ||
+        (profiling && profile == 0))
+    {
+        printf("Error: could not allocate the %s.\n", (profiling && profile == 0) ? "profile" : "locality trackers");
+        if (profile)
+        {
+            freeProfile(profile);
+        }
+        if (l1Reuse)
+        {
+            freeReuseTracker(l1Reuse);
+        }
+        if (l2Reuse)
+        {
+            freeReuseTracker(l2Reuse);
+        }
+        if (workingSet)
+        {
+            freeWorkingSetTracker(workingSet);
+        }
+        if (filter)
+        {
+            closeTraceWriter(filter);
+        }
+        if (workingSetFP)
+        {
+            fclose(workingSetFP);
+        }
+        closeTrace(trace);
+        cacheSimDestroy(sim);
+        return -1;
+    }
 
-            /* Read With Prefetching */
-            /* Check L1 cache */
-            hit = fetch(l1WithPrefetchCache, 0, l1AddressTag, l1AddressSet, l1NumLines, l1NumSets);
+    /* Phase timers, started last so setup is not charged to any phase */
+    if (profile)
+    {
+        cacheSimSetProfile(sim, profile);
+        startProfile(profile);
+    }
 
-            /* If L1 Cache Hit */
-            if (hit)
-            {
-                l1WithPrefetchCacheHits++;
-            }
-            /* If L1 Cache Miss */
-            else
+    /* Simulation */
+    /* Read in each access from the trace, until the end */
+    CacheSimAccess access;
+    int result;
+    /* The accesses to the same block that follow each one */
+    unsigned long long int repeats, repeatWrites;
+    /* Writes that hit L1 go straight through to memory, so a filtered trace only counts them */
+    unsigned long long int l1WriteHits = 0;
+
+    while (readTraceRun(trace, &access, &repeats, &repeatWrites))
+    {
+        if (profile)
+        {
+            markProfile(profile, PROFILE_PARSE);
+        }
+        if (mode == MODE_FILTER_L1)
+        {
+            result = cacheSimAccessL1(sim, access.address, access.pc, access.operation);
+            if (access.operation == 'R' || access.operation == 'W')
             {
-                l1WithPrefetchCacheMisses++;
-
-                /* Check L2 cache */
-                l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-
-                hit = fetch(l2WithPrefetchCache, 0, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
-
-                /* If L2 Cache Hit */
-                if (hit)
+                if (result != CACHESIM_L1_HIT)
                 {
-                    l2WithPrefetchCacheHits++;
+                    writeTrace(filter, &access);
                 }
-                /* If L2 Cache Miss */
-                else
+                else if (access.operation == 'W')
                 {
-                    l2WithPrefetchCacheMisses++;
-                    withPrefetchMemoryReads++;
-
-                    /* Prefetch */
-                    /* Get the new address by adding the Block Size */
-                    address += l2CacheBlockSize;
-                    /* Get the Tag and the Set from the new Address */
-                    l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                    l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-
-                    hit = fetch(l2WithPrefetchCache, 1, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
-
-                    /* If Cache Hit */
-                    if (hit)
-                    {
-
-                    }
-                    /* If Cache Miss */
-                    else
-                    {
-                        withPrefetchMemoryReads++;
-                    }
+                    l1WriteHits++;
                 }
             }
         }
-
-        /* If operation is a Write */
-        else if (operation == 'W')
+        else if (mode == MODE_L2_ONLY)
+        {
+            result = cacheSimAccessL2(sim, access.address, access.pc, access.operation);
+        }
+        else
         {
-            /* Write Without Prefetching */
-            /* Check L1 cache */
-            hit = fetch(l1NoPrefetchCache, 0, l1AddressTag, l1AddressSet, l1NumLines, l1NumSets);
+            result = cacheSimAccess(sim, access.address, access.pc, access.operation);
+        }
+        if (repeats)
+        {
+            cacheSimRepeatAccess(sim, repeats, repeatWrites);
+            l1WriteHits += repeatWrites;
+        }
 
-            /* If Cache Hit */
-            if (hit)
+        if (access.operation == 'R' || access.operation == 'W')
+        {
+            if (l1Reuse)
             {
-                l1NoPrefetchCacheHits++;
-                noPrefetchMemoryWrites++;
+                recordReuse(l1Reuse, access.address);
             }
-            /* If Cache Miss */
-            else
+            if (l2Reuse && result != CACHESIM_L1_HIT)
             {
-                l1NoPrefetchCacheMisses++;
-
-                /* Check L2 cache */
-                l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-
-                hit = fetch(l2NoPrefetchCache, 0, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
-
-                /* If L2 Cache Hit */
-                if (hit)
-                {
-                    l2NoPrefetchCacheHits++;
-                    noPrefetchMemoryWrites++;
-                }
-                /* If L2 Cache Miss */
-                else
-                {
-                    l2NoPrefetchCacheMisses++;
-                    noPrefetchMemoryReads++;
-                    noPrefetchMemoryWrites++;
-                }
+                recordReuse(l2Reuse, access.address);
+            }
+            if (workingSet)
+            {
+                recordWorkingSet(workingSet, access.address);
             }
+        }
+        if (profile)
+        {
+            markProfile(profile, PROFILE_OTHER);
+        }
+    }
+    if (profile)
+    {
+        markProfile(profile, PROFILE_PARSE);
+    }
 
-            /* Write With Prefetching */
-            /* Check L1 cache */
-            hit = fetch(l1WithPrefetchCache, 0, l1AddressTag, l1AddressSet, l1NumLines, l1NumSets);
+    /* Print the results */
+    int status = 0;
+    CacheSimStats stats;
+    cacheSimGetStats(sim, &stats);
+    /* Accesses this run simulated, before --l2-only restores the L1 counts */
+    unsigned long long int simulated = stats.noPrefetch.totalInstructions;
 
-            /* If Cache Hit */
-            if (hit)
+    if (mode == MODE_FILTER_L1)
+    {
+        /* Store the L1 configuration and counters with the filtered trace */
+        char metadata[256];
+        snprintf(metadata, sizeof(metadata), "l1 size=%d assoc=%d block=%d accesses=%llu hits=%llu misses=%llu write_hits=%llu index=%d "
+                 "sectors=%d sector_misses=%llu",
+                 config.l1.size, config.l1.associativity, config.l1.blockSize, stats.noPrefetch.totalInstructions,
+                 stats.noPrefetch.l1CacheHits, stats.noPrefetch.l1CacheMisses, l1WriteHits, config.l1.indexFunction,
+                 l1Sectors > 1 ? l1Sectors : 1, stats.noPrefetch.l1SectorMisses);
+        setTraceMetadata(filter, metadata);
+        closeTraceWriter(filter);
+
+        printf("-----\nL1 Filter\n-----\n");
+        printf("Total instructions: %llu\n", stats.noPrefetch.totalInstructions);
+        printf("L1 cache hits: %llu\n", stats.noPrefetch.l1CacheHits);
+        printf("L1 cache misses: %llu\n", stats.noPrefetch.l1CacheMisses);
+        printf("L1 cache miss rate: %.3f\n", (float) stats.noPrefetch.l1CacheMisses / stats.noPrefetch.totalInstructions);
+        printf("Filtered trace records: %llu\n", stats.noPrefetch.l1CacheMisses);
+    }
+    else
+    {
+        /* Restore the L1 side of the counters from the filtered trace */
+        int valid = 1;
+        if (mode == MODE_L2_ONLY)
+        {
+            /* Traces filtered before index functions existed used the modulo index, and before sectors, whole blocks */
+            CacheSimLevelConfig l1;
+            l1.indexFunction = CACHESIM_INDEX_MODULO;
+            l1.sectors = 1;
+            unsigned long long int accesses, hits, misses, writeHits, sectorMisses = 0;
+            if (sscanf(trace -> metadata, "l1 size=%d assoc=%d block=%d accesses=%llu hits=%llu misses=%llu write_hits=%llu index=%d "
+                       "sectors=%d sector_misses=%llu",
+                       &l1.size, &l1.associativity, &l1.blockSize, &accesses, &hits, &misses, &writeHits, &l1.indexFunction,
+                       &l1.sectors, &sectorMisses) < 7)
             {
-                l1WithPrefetchCacheHits++;
-                withPrefetchMemoryWrites++;
+                printf("Error: trace was not written by --filter-l1.\n");
+                valid = 0;
+            }
+            else if (l1.size != config.l1.size || l1.associativity != config.l1.associativity || l1.blockSize != config.l1.blockSize ||
+                     l1.indexFunction != config.l1.indexFunction || l1.sectors != (l1Sectors > 1 ? l1Sectors : 1))
+            {
+                printf("Error: filtered trace was made with a different L1 configuration (%d %d %d).\n",
+                       l1.size, l1.associativity, l1.blockSize);
+                valid = 0;
             }
-            /* If Cache Miss */
             else
             {
-                l1WithPrefetchCacheMisses++;
-
-                /* Check L2 cache */
-                l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-
-                hit = fetch(l2WithPrefetchCache, 0, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
-
-                /* If L2 Cache Hit */
-                if (hit)
-                {
-                    l2WithPrefetchCacheHits++;
-                    withPrefetchMemoryWrites++;
-                }
-                /* If L2 Cache Miss */
-                else
-                {
-                    l2WithPrefetchCacheMisses++;
-                    withPrefetchMemoryReads++;
-                    withPrefetchMemoryWrites++;
-
-                    /* Prefetch */
-                    /* Get the new address by adding the Block Size */
-                    address += l2CacheBlockSize;
-                    /* Get the Tag and the Set from the new Address */
-                    l2AddressTag = getTag(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-                    l2AddressSet = getSet(address, l2SetBits, l2TagBits, l2BlockOffsetBits);
-
-                    hit = fetch(l2WithPrefetchCache, 1, l2AddressTag, l2AddressSet, l2NumLines, l2NumSets);
-
-                    /* If Cache Hit */
-                    if (hit)
-                    {
-                        
-                    }
-                    /* If Cache Miss */
-                    else
-                    {
-                        withPrefetchMemoryReads++;
-                    }
-                }
+                stats.noPrefetch.totalInstructions = stats.withPrefetch.totalInstructions = accesses;
+                stats.noPrefetch.l1CacheHits = stats.withPrefetch.l1CacheHits = hits;
+                stats.noPrefetch.l1SectorMisses = stats.withPrefetch.l1SectorMisses = sectorMisses;
+                stats.noPrefetch.memoryWrites += writeHits;
+                stats.withPrefetch.memoryWrites += writeHits;
             }
         }
 
-        /*
-        printCache(noPrefetchCache, numSets, numLines);
-        printCache(withPrefetchCache, numSets, numLines);
-        printf("no-prefetch\n");
-        printCounters(noPrefetchMemoryReads, noPrefetchMemoryWrites, noPrefetchCacheHits, noPrefetchCacheMisses);
-        printf("with-prefetch\n");
-        printCounters(withPrefetchMemoryReads, withPrefetchMemoryWrites, withPrefetchCacheHits, withPrefetchCacheMisses);
-        printf("++++++++++++++++++++++++++++++++\n");
-        */
+        if (!valid)
+        {
+            status = -1;
+            if (l2Reuse)
+            {
+                freeReuseTracker(l2Reuse);
+                l2Reuse = 0;
+            }
+        }
+        else
+        {
+            printStats(&stats, &config, tlbSpec != 0);
 
-        fscanf(traceFP, "%99[^\n]", line);
-        getc(traceFP);
+            if (memoDir && storeMemo(memoDir, memoKey, &stats))
+            {
+                printf("Error: could not store the result in memo directory %s.\n", memoDir);
+                status = -1;
+            }
+        }
     }
 
-    float l1NoPrefectMissRate = (float) l1NoPrefetchCacheMisses / totalInstructions;
-    float l2NoPrefectMissRate = (float) l2NoPrefetchCacheMisses / l1NoPrefetchCacheMisses;
-    float overallNoPrefetchMissRate = (float) l2NoPrefetchCacheMisses / totalInstructions;
-
-    float l1WithPrefectMissRate = (float) l1WithPrefetchCacheMisses / totalInstructions;
-    float l2WithPrefectMissRate = (float) l2WithPrefetchCacheMisses / l1WithPrefetchCacheMisses;
-    float overallWithPrefetchMissRate = (float) l2WithPrefetchCacheMisses / totalInstructions;
-
-    /* Print the results */
-    printf("-----\nNo Prefetch\n-----\n");
-    printCounters(totalInstructions,
-                  noPrefetchMemoryReads,
-                  noPrefetchMemoryWrites,
-                  l1NoPrefetchCacheHits,
-                  l1NoPrefetchCacheMisses,
-                  l1NoPrefectMissRate,
-                  l2NoPrefetchCacheHits,
-                  l2NoPrefetchCacheMisses,
-                  l2NoPrefectMissRate,
-                  overallNoPrefetchMissRate);
-
-    printf("-----\nWith Prefetch\n-----\n");
-    printCounters(totalInstructions,
-                  withPrefetchMemoryReads,
-                  withPrefetchMemoryWrites,
-                  l1WithPrefetchCacheHits,
-                  l1WithPrefetchCacheMisses,
-                  l1WithPrefectMissRate,
-                  l2WithPrefetchCacheHits,
-                  l2WithPrefetchCacheMisses,
-                  l2WithPrefectMissRate,
-                  overallWithPrefetchMissRate);
-
-    /* printf("Count: %lu\n", count); */
-
-    /* Close file */
-    fclose(traceFP);
-
-    /* Free memory */
-    /* Free each Set's Lines */
-    for (i = 0; i < l1NumSets; i++)
+    if (l1Reuse)
     {
-        /* Free each Line */
-        free(l1NoPrefetchCache -> sets[i].lines);
-        free(l1WithPrefetchCache -> sets[i].lines);
+        printReuseHistogram(l1Reuse, "L1");
+        freeReuseTracker(l1Reuse);
     }
-    for (i = 0; i < l2NumSets; i++)
+    if (l2Reuse)
     {
-        /* Free each Line */
-        free(l2NoPrefetchCache -> sets[i].lines);
-        free(l2WithPrefetchCache -> sets[i].lines);
+        printReuseHistogram(l2Reuse, "L2");
+        freeReuseTracker(l2Reuse);
     }
-
-    /* Free the Caches' hash table of Sets */
-    free(l1NoPrefetchCache -> sets);
-    free(l1WithPrefetchCache -> sets);
-    free(l2NoPrefetchCache -> sets);
-    free(l2WithPrefetchCache -> sets);
-
-    /* Free the Cache structs */
-    free(l1NoPrefetchCache);
-    free(l1WithPrefetchCache);
-    free(l2NoPrefetchCache);
-    free(l2WithPrefetchCache);
-
-    return 0;
-}
-
-
-int isPowerOfTwo(int n)
-{
-    /* Return 0 if n is not a power of 2, 1 otherwise */
-
-    /* If n is 0, n is not a power of 2 */
-    if (n == 0)
+    if (workingSet)
     {
-        return 0;
+        printWorkingSetSummary(workingSet);
+        freeWorkingSetTracker(workingSet);
+        fclose(workingSetFP);
     }
-    /* Continue dividing n by 2 until a remainder is found (return 0) or n is 1 (return 1) */
-    while (n != 1)
+
+    if (profile)
     {
-        /* If a remainder is found, n is not a power of 2 */
-        if (n % 2 != 0)
-        {
-            return 0;
-        }
-        /* Divide n by 2 */
-        n = n / 2;
+        markProfile(profile, PROFILE_OUTPUT);
+        stopProfile(profile);
+        printProfile(profile, simulated);
+        freeProfile(profile);
     }
 
-    /* Here, n must be a power of 2 */
-    return 1;
+    /* Close file */
+    closeTrace(trace);
+
+    /* Free memory */
+    cacheSimDestroy(sim);
+
+    return status;
 }
 
 
@@ -690,305 +861,492 @@ int getAssociativity(char *cacheAssociativity)
 }
 
 
-void printCounters(int totalInstructions,
-                   int memoryReads,
-                   int memoryWrites,
-                   int l1CacheHits,
-                   int l1CacheMisses,
-                   float l1MissRate,
-                   int l2CacheHits,
-                   int l2CacheMisses,
-                   float l2MissRate,
-                   float overallMissRate)
+int parseAssociativity(char *cacheAssociativity, const char *name, int *associativity)
 {
-    printf("Total instructions: %d\n", totalInstructions);
-    printf("Memory reads: %d\n", memoryReads);
-    printf("Memory writes: %d\n", memoryWrites);
-    printf("L1 cache hits: %d\n", l1CacheHits);
-    printf("L1 cache misses: %d\n", l1CacheMisses);
-    printf("L1 cache miss rate: %.3f\n", l1MissRate);
-    printf("L2 cache hits: %d\n", l2CacheHits);
-    printf("L2 cache misses: %d\n", l2CacheMisses);
-    printf("L2 cache miss rate: %.3f\n", l2MissRate);
-    printf("Overall cache miss rate: %.3f\n", overallMissRate);
+    /* Translate direct, assoc or assoc:n into a number of ways (0 for fully associative);
+     * return -1 on error */
+
+    /* If cache is direct (strcmp returns 0 if strings are equal), there is one way */
+    if (!strcmp(cacheAssociativity, "direct"))
+    {
+        *associativity = 1;
+        return 0;
+    }
+
+    /* Otherwise, 0 means fully associative and a positive n means n-way associative */
+    int cacheAssociativityResult = getAssociativity(cacheAssociativity);
+
+    /* If cacheAssociativityResult is -1, error */
+    if (cacheAssociativityResult < 0)
+    {
+        printf("Error: invalid %s cache associativity.\n", name);
+        return -1;
+    }
+
+    *associativity = cacheAssociativityResult;
+    return 0;
 }
 
 
-int logBase2(int n)
+int parseTlbs(const char *spec, CacheSimConfig *config)
 {
-    /* Continue shifting right until n is 0 */
-    int log = 0;
-    while (n - 1 > 0)
+    /* Read "d:w,i:w,l:w", the entries and ways (0 for fully associative) of the L1 DTLB,
+     * L1 ITLB and L2 TLB; return -1 if spec is malformed */
+    char extra;
+    if (sscanf(spec, "%d:%d,%d:%d,%d:%d%c", &config -> dtlb.entries, &config -> dtlb.associativity,
+               &config -> itlb.entries, &config -> itlb.associativity,
+               &config -> l2Tlb.entries, &config -> l2Tlb.associativity, &extra) != 6)
+    {
+        return -1;
+    }
+    /* Zero entries would turn the TLBs off */
+    if (config -> dtlb.entries <= 0)
     {
-        n = n >> 1;
-        log++;
+        return -1;
     }
 
-    return log;
+    return 0;
 }
 
 
-unsigned long long int getTag(unsigned long long int address, int setBits, int tagBits, int blockOffset)
+int parsePageSize(const char *pageSize)
 {
-    /* The mask that will be used to get the ith bit */
-    unsigned long long int mask = 1;
-    
-    /* Shift address right by blockOffset and setBits */
-    address = address >> (blockOffset + setBits);
-
-    /* For each bit after the blockOffset and setBits */
-    unsigned long long int tag = 0;
-    int i;
-    for (i = 0; i < tagBits; i++)
+    /* Translate 4k, 2m or 1g into bytes; anything else is left for cacheSimCheckConfig to reject */
+    if (!strcasecmp(pageSize, "4k"))
+    {
+        return 4096;
+    }
+    if (!strcasecmp(pageSize, "2m"))
+    {
+        return 2097152;
+    }
+    if (!strcasecmp(pageSize, "1g"))
     {
-        /* AND the ith bit of address with mask, and add it to tag */
-        tag += address & mask;
+        return 1073741824;
+    }
+    return atoi(pageSize);
+}
 
-        /* printf("Tag %d, Address & Mask %lu\n", tag, address & mask); */
 
-        /* Shift mask left */
-        mask = mask << 1;
+int parseDram(const char *spec, CacheSimDramConfig *dram)
+{
+    /* Read "channels:banks[:row_bytes[:burst_bytes]]", defaulting to DDR4-like rows and bursts;
+     * return -1 if spec is malformed. The values are left for cacheSimCheckConfig to check */
+    char extra;
+    dram -> rowSize = DRAM_DEFAULT_ROW_SIZE;
+    dram -> burstSize = DRAM_DEFAULT_BURST_SIZE;
+    int fields = sscanf(spec, "%d:%d:%d:%d%c", &dram -> channels, &dram -> banks, &dram -> rowSize, &dram -> burstSize, &extra);
+    if (fields < 2 || fields > 4)
+    {
+        return -1;
+    }
+    /* Zero channels would turn DRAM off */
+    if (dram -> channels <= 0)
+    {
+        return -1;
     }
 
-    return tag;
+    return 0;
 }
 
 
-unsigned long int getSet(unsigned long long int address, int setBits, int tagBits, int blockOffset)
+int parseIndexFunction(const char *name)
 {
-    /* The mask that will be used to get the ith bit */
-    unsigned long long int mask = 1;
-    
-    /* Shift address right by blockOffset */
-    address = address >> blockOffset;
-
-    /* For each bit after the blockOffset */
-    unsigned long int set = 0;
-    int i;
-    for (i = 0; i < setBits; i++)
+    /* Translate modulo, xor, prime or skewed into a CACHESIM_INDEX_ function;
+     * -1 is left for cacheSimCheckConfig to reject */
+    if (!strcmp(name, "modulo"))
+    {
+        return CACHESIM_INDEX_MODULO;
+    }
+    if (!strcmp(name, "xor"))
     {
-        /* AND the ith bit of address with mask, and add it to set */
-        set += address & mask;
+        return CACHESIM_INDEX_XOR;
+    }
+    if (!strcmp(name, "prime"))
+    {
+        return CACHESIM_INDEX_PRIME;
+    }
+    if (!strcmp(name, "skewed"))
+    {
+        return CACHESIM_INDEX_SKEWED;
+    }
+    return -1;
+}
 
-        /* printf("Set %d, Address & Mask %lu\n", set, address & mask); */
 
-        /* Shift mask left */
-        mask = mask << 1;
+int parseList(const char *list, int *values, int maxValues)
+{
+    /* Parse up to maxValues comma-separated positive integers; returns how many, or -1 if malformed */
+    int count = 0;
+    const char *p = list;
+    char *end;
+    while (*p)
+    {
+        long int value = strtol(p, &end, 10);
+        if (end == p || value < 1 || count == maxValues || (*end != ',' && *end != '\0'))
+        {
+            return -1;
+        }
+        values[count++] = (int) value;
+        p = (*end == ',') ? end + 1 : end;
     }
+    return count;
+}
 
-    return set;
+
+int parsePartition(const char *spec, int *partition, int *ways, int *numWays, unsigned long int *interval)
+{
+    /* Parse none, ways:w0,w1,... or ucp[:interval]; returns 0 on success, -1 otherwise */
+    *numWays = 0;
+    *interval = SHARED_DEFAULT_UCP_INTERVAL;
+    if (!strcmp(spec, "none"))
+    {
+        *partition = PARTITION_NONE;
+        return 0;
+    }
+    if (!strncmp(spec, "ways:", 5))
+    {
+        *partition = PARTITION_WAYS;
+        *numWays = parseList(spec + 5, ways, SHARED_MAX_TENANTS);
+        return *numWays > 0 ? 0 : -1;
+    }
+    if (!strcmp(spec, "ucp"))
+    {
+        *partition = PARTITION_UCP;
+        return 0;
+    }
+    if (!strncmp(spec, "ucp:", 4))
+    {
+        char *end;
+        *partition = PARTITION_UCP;
+        *interval = strtoul(spec + 4, &end, 10);
+        return (*end == '\0' && *interval > 0) ? 0 : -1;
+    }
+    return -1;
 }
 
 
-int fetch(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set, int numLines, int numSets)
+int simulateTenants(const CacheSimConfig *config, char **tenantSpecs, int numTenants, const int *weights, int traceFormat,
+                    const char *partitionSpec, unsigned long long int skipRecords, unsigned long long int limitRecords,
+                    int readahead)
 {
-    /* Return 1 on a Cache Hit, 0 on a Cache Miss */
-    int hit = 0;
-
-    /* Hash the Tag and the Set */
-    int tagIndex = hash(tag, numLines);
-    int setIndex = hash(set, numSets);
-
-    /* printf("Tag is %llx. Indexing Set %d Line %d\n", tag, setIndex, tagIndex); */
-    /* Index into the Cache and retrieve the proper Valid bit and Tag */
-    int validBit = cache -> sets[setIndex].lines[tagIndex].valid;
-    unsigned long long int currentTag = cache -> sets[setIndex].lines[tagIndex].tag;
-    
-    /*
-    printf("Fetching SetIndex %d TagIndex %d\n", setIndex, tagIndex);
-    printf("Comparing %lu to %lu\n", tag, currentTag);
-     */
-    
-    /* If the Valid bit is 1 and the current Tag at tagIndex matches the new Tag, Cache Hit */
-    if (validBit && (currentTag == tag))
-    {
-        /* printf("HIT\n"); */
-        hit = 1;
-    }
-    /* If the Valid bit is 1 and the current Tag at tagIndex does not match the new Tag */
-    else if (validBit && (currentTag != tag))
-    {
-        /* Linearly probe the adjacent Lines in the Set;
-         * If the Valid bit is 1 and the current Tag at ((tagIndex + i) % numLines) matches the new Tag, Cache Hit)
-         * If no matches are found, Cache Miss, evict LRU from cache and bring new address into cache
-         */
-        int i, iIndex, iValid, found = 0;
-        unsigned long long int iTag = 0;
-        for (i = 1; i < numLines; i++)
-        {
-            iIndex = hash(tagIndex + i, numLines);
-            iValid = cache -> sets[setIndex].lines[iIndex].valid;
-            iTag = cache -> sets[setIndex].lines[iIndex].tag;
-            
-            /* printf("LINEAR PROBE: Comparing %llx to %llx\n", tag, iTag); */
-            
-            /* If the Valid bit is 1 and the current Tag at ((tagIndex + i) % numLines) matches the new Tag, Cache Hit */
-            if (iValid && (iTag == tag))
+    /* Interleave the tenants' traces, weights[t] accesses of tenant t per turn, through
+     * private L1s and a shared L2, until every trace has ended; returns 0 on success */
+    int partition = PARTITION_NONE;
+    int ways[SHARED_MAX_TENANTS];
+    int numWays = 0;
+    unsigned long int interval = SHARED_DEFAULT_UCP_INTERVAL;
+    if (partitionSpec && parsePartition(partitionSpec, &partition, ways, &numWays, &interval))
+    {
+        printf("Error: improperly formatted partitioning; expected none, ways:w0,w1,... or ucp[:interval].\n");
+        return -1;
+    }
+    if (partition == PARTITION_WAYS && numWays != numTenants)
+    {
+        printf("Error: --partition ways needs one number of ways per tenant.\n");
+        return -1;
+    }
+
+    char error[128];
+    SharedCache *shared = createSharedCache(config, numTenants, partition, ways, interval, error, sizeof(error));
+    if (shared == 0)
+    {
+        printf("Error: %s\n", error);
+        return -1;
+    }
+
+    /* Open each tenant's trace; a gen: prefix generates a synthetic workload instead */
+    TraceReader *traces[SHARED_MAX_TENANTS];
+    int status = 0;
+    int t;
+    for (t = 0; t < numTenants; t++)
+    {
+        if (!strncmp(tenantSpecs[t], "gen:", 4))
+        {
+            SyntheticGenerator *generator = createGenerator(tenantSpecs[t] + 4, error, sizeof(error));
+            traces[t] = generator ? openSyntheticTrace(generator) : 0;
+            if (generator == 0)
             {
-                /* printf("HIT\n"); */
-                hit = 1, found = 1;
-                
-                /* Update the blocks' Least Recently Used properties */
-                /* updateLRU(cache, tagIndex, setIndex, numLines); */
-                
-                tagIndex = iIndex;
-                
-                break;
+                printf("Error: tenant %d: %s\n", t, error);
+                status = -1;
             }
         }
-        /* If no matches are found, Cache Miss */
-        if (!found)
+        else
         {
-            /* printf("MISS\n"); */
-            hit = 0;
-            
-            /* If Set is not full */
-            if (cache -> sets[setIndex].numItems < numLines)
+            traces[t] = openTrace(tenantSpecs[t], traceFormat);
+            if (traces[t] == 0)
             {
-                /* Search for an empty space */
-                for (i = 1; i < numLines; i++)
-                {
-                    iIndex = hash(tagIndex + i, numLines);
-                    iValid = cache -> sets[setIndex].lines[iIndex].valid;
-                    
-                    /* If the Valid bit is 0, Cache Miss, bring new address into the Cache, write into empty location */
-                    if (!iValid)
-                    {
-                        /* Bring new address into the Cache, write into empty location */
-                        cache -> sets[setIndex].lines[iIndex].valid = 1;
-                        cache -> sets[setIndex].lines[iIndex].tag = tag;
-                        cache -> sets[setIndex].numItems++;
-                        
-                        /* Update the blocks' Least Recently Used properties */
-                        /* updateLRU(cache, tagIndex, setIndex, numLines); */
-                        
-                        tagIndex = iIndex;
-                        break;
-                    }
-                }
-            }
-            /* If Set is full */
-            else if (cache -> sets[setIndex].numItems == numLines)
-            {
-                /* Update the blocks' Least Recently Used properties */
-                /* updateLRU(cache, tagIndex, setIndex, numLines); */
-                
-                /* Evict LRU from cache and bring address into cache */
-                int evictedIndex = evict(cache, tag, setIndex, numLines);
-                
-                tagIndex = evictedIndex;
+                printf("Error: trace file %s not found.\n", tenantSpecs[t]);
+                status = -1;
             }
         }
+        if (traces[t] == 0)
+        {
+            break;
+        }
+        traces[t] -> splitBlockSize = config -> l1.blockSize;
+        if (skipRecords && seekTrace(traces[t], skipRecords))
+        {
+            printf("Error: trace %s has fewer than %llu records.\n", tenantSpecs[t], skipRecords);
+            closeTrace(traces[t]);
+            status = -1;
+            break;
+        }
+        if (limitRecords)
+        {
+            traces[t] -> recordLimit = skipRecords + limitRecords;
+        }
+        if (readahead && startTraceReadahead(traces[t]))
+        {
+            printf("Error: could not start the readahead thread for trace %s.\n", tenantSpecs[t]);
+            closeTrace(traces[t]);
+            status = -1;
+            break;
+        }
     }
-    /* If the Valid bit is not 1, Cache Miss */
-    else if (!validBit)
+    if (status)
     {
-        /* printf("MISS\n"); */
-        hit = 0;
-        
-        /* Bring new address into the Cache, write into empty location */
-        cache -> sets[setIndex].lines[tagIndex].valid = 1;
-        cache -> sets[setIndex].lines[tagIndex].tag = tag;
-        cache -> sets[setIndex].numItems++;
+        while (--t >= 0)
+        {
+            closeTrace(traces[t]);
+        }
+        freeSharedCache(shared);
+        return status;
     }
-    
-    
-    if (!prefetching || !hit)
+
+    /* Simulation */
+    CacheSimAccess access;
+    int running[SHARED_MAX_TENANTS];
+    int numRunning = numTenants;
+    for (t = 0; t < numTenants; t++)
     {
-        /* Update the blocks' Least Recently Used properties */
-        updateLRU(cache, tagIndex, setIndex, numLines);
+        running[t] = 1;
     }
-
-    return hit;
-}
-
-
-void updateLRU(Cache *cache, int tagIndex, int setIndex, int numLines)
-{
-    /* Assume that the block at [setIndex][tagIndex] has been used.
-     * Update the usage of each line in the set. */
-    int i;
-    for (i = 0; i < numLines; i++)
+    while (numRunning)
     {
-        /* If the current line is the line that was just used */
-        if (i == tagIndex)
+        for (t = 0; t < numTenants; t++)
         {
-            /* This line is most recently used */
-            cache -> sets[setIndex].lines[i].usage = 1;
+            int turn;
+            for (turn = 0; running[t] && turn < weights[t]; turn++)
+            {
+                if (readTrace(traces[t], &access))
+                {
+                    accessSharedCache(shared, t, access.address, access.operation);
+                }
+                else
+                {
+                    running[t] = 0;
+                    numRunning--;
+                }
+            }
         }
-        /* Otherwise, if the current line has been used */
-        else if (cache -> sets[setIndex].lines[i].usage > 0)
+    }
+
+    /* Print the results */
+    static const char *policies[] = { "none", "ways", "ucp" };
+    printf("-----\nShared L2\n-----\n");
+    printf("Tenants: %d\n", numTenants);
+    printf("Partitioning: %s\n", policies[partition]);
+    if (partition == PARTITION_UCP)
+    {
+        printf("Repartitions: %lu (every %lu L2 accesses)\n", shared -> repartitions, interval);
+    }
+
+    unsigned long long int l2Misses = 0, aloneL2Misses = 0;
+    for (t = 0; t < numTenants; t++)
+    {
+        SharedTenant *tenant = &shared -> tenants[t];
+        printf("-----\nTenant %d: %s (weight %d)\n-----\n", t, tenantSpecs[t], weights[t]);
+        printCounters(&tenant -> counters, config);
+        printf("L2 cache misses alone: %llu\n", tenant -> aloneL2Misses);
+        printf("L2 cache misses from sharing: %lld\n", (long long int) (tenant -> counters.l2CacheMisses - tenant -> aloneL2Misses));
+        printf("L2 blocks evicted by other tenants: %llu\n", tenant -> evictedByOthers);
+        if (partition != PARTITION_NONE)
         {
-            /* Increment usage */
-            cache -> sets[setIndex].lines[i].usage++;
+            printf("L2 ways: %d\n", tenant -> ways);
         }
+        l2Misses += tenant -> counters.l2CacheMisses;
+        aloneL2Misses += tenant -> aloneL2Misses;
+        closeTrace(traces[t]);
     }
+    printf("-----\nAll Tenants\n-----\n");
+    printf("L2 cache misses: %llu\n", l2Misses);
+    printf("L2 cache misses alone: %llu\n", aloneL2Misses);
+    printf("L2 cache misses from sharing: %lld\n", (long long int) (l2Misses - aloneL2Misses));
+
+    freeSharedCache(shared);
+    return 0;
 }
 
 
-int evict(Cache *cache, unsigned long long int tag, int setIndex, int numLines)
+void printStats(const CacheSimStats *stats, const CacheSimConfig *config, int tlb)
 {
-    /* Find the Least Recently Used block and replace it with the given block */
-    int indexOfLRU = 0;
-    long int max = 0;
-    int i;
+    printf("-----\nNo Prefetch\n-----\n");
+    printCounters(&stats -> noPrefetch, config);
+
+    printf("-----\nWith Prefetch\n-----\n");
+    printCounters(&stats -> withPrefetch, config);
 
-    for (i = 0; i < numLines; i++)
+    if (tlb)
     {
-        if (cache -> sets[setIndex].lines[i].usage > max)
-        {
-            max = cache -> sets[setIndex].lines[i].usage;
-            indexOfLRU = i;
-        }
+        printf("-----\nTLB\n-----\n");
+        printTlbCounters(&stats -> tlb);
     }
 
-    /* printf("Evicting %llx\n", cache -> sets[setIndex].lines[indexOfLRU].tag); */
-    cache -> sets[setIndex].lines[indexOfLRU].tag = tag;
-    
-    return indexOfLRU;
+    if (config -> dram.channels)
+    {
+        printf("-----\nDRAM, No Prefetch\n-----\n");
+        printDramCounters(&stats -> noPrefetchDram, config, stats -> noPrefetch.totalInstructions);
+
+        printf("-----\nDRAM, With Prefetch\n-----\n");
+        printDramCounters(&stats -> withPrefetchDram, config, stats -> withPrefetch.totalInstructions);
+    }
 }
 
 
-void printCache(Cache *cache, int numSets, int numLines)
+void printCounters(const CacheSimCounters *counters, const CacheSimConfig *config)
 {
-    int currentValidBit;
-    unsigned long long int currentTag;
-    int currentUsage;
-
-    printf("----------------------------------------------------\n");
-    int i, j;
-    for (i = 0; i < numSets; i++)
+    /* L2 sees the L1 misses that the L1 victim cache did not serve. An L1 fill larger than
+     * what L2 brings in takes several L2 lookups, so the L2 counters are per lookup, while
+     * the overall miss rate counts each access that read memory once */
+    float l1MissRate = (float) counters -> l1CacheMisses / counters -> totalInstructions;
+    float l2MissRate = (float) counters -> l2CacheMisses / (counters -> l2CacheHits + counters -> l2CacheMisses);
+    float overallMissRate = (float) counters -> overallMisses / counters -> totalInstructions;
+    int l1Fill = config -> l1.sectors > 1 ? config -> l1.blockSize / config -> l1.sectors : config -> l1.blockSize;
+    int l2Fill = config -> l2.sectors > 1 ? config -> l2.blockSize / config -> l2.sectors : config -> l2.blockSize;
+
+    printf("Total instructions: %llu\n", counters -> totalInstructions);
+    /* A sectored L2 reads a sector at a time */
+    if (config -> l2.sectors > 1)
     {
-        printf("Set %d:\n", i);
-        for (j = 0; j < numLines; j++)
-        {
-            currentValidBit = cache -> sets[i].lines[j].valid;
-            currentTag = cache -> sets[i].lines[j].tag;
-            currentUsage = cache -> sets[i].lines[j].usage;
+        printf("Memory reads (L2 sectors): %llu\n", counters -> memoryReads);
+        printf("Memory bytes read: %llu\n", counters -> memoryReads * l2Fill);
+    }
+    else
+    {
+        printf("Memory reads: %llu\n", counters -> memoryReads);
+    }
+    printf("Memory writes: %llu\n", counters -> memoryWrites);
+    printf("L1 cache hits: %llu\n", counters -> l1CacheHits);
+    printf("L1 cache misses: %llu\n", counters -> l1CacheMisses);
+    printf("L1 cache miss rate: %.3f\n", l1MissRate);
+    if (config -> l1.sectors > 1)
+    {
+        printf("L1 sector misses (line present): %llu\n", counters -> l1SectorMisses);
+    }
+    if (config -> l1.victimEntries)
+    {
+        printf("L1 %s cache hits (misses saved): %llu\n", config -> l1.missCache ? "miss" : "victim", counters -> l1VictimHits);
+    }
+    printf("L2 cache hits: %llu\n", counters -> l2CacheHits);
+    printf("L2 cache misses: %llu\n", counters -> l2CacheMisses);
+    printf("L2 cache miss rate: %.3f\n", l2MissRate);
+    if (l1Fill > l2Fill)
+    {
+        printf("L2 lookups (%d per L1 fill): %llu\n", l1Fill / l2Fill, counters -> l2CacheHits + counters -> l2CacheMisses);
+        printf("L1 fills read from memory: %llu\n", counters -> overallMisses);
+    }
+    if (config -> l2.sectors > 1)
+    {
+        printf("L2 sector misses (line present): %llu\n", counters -> l2SectorMisses);
+    }
+    if (config -> l2.victimEntries)
+    {
+        printf("L2 %s cache hits (misses saved): %llu\n", config -> l2.missCache ? "miss" : "victim", counters -> l2VictimHits);
+    }
+    printf("Overall cache miss rate: %.3f\n", overallMissRate);
+}
 
-            printf("\tLine %d: Valid - %d | Tag - %llx | Usage - %d\n", j, currentValidBit, currentTag, currentUsage);
-        }
+
+void printTlbCounters(const CacheSimTlbCounters *counters)
+{
+    printf("L1 DTLB hits: %llu\n", counters -> dtlbHits);
+    printf("L1 DTLB misses: %llu\n", counters -> dtlbMisses);
+    printf("L1 DTLB miss rate: %.3f\n", (float) counters -> dtlbMisses / (counters -> dtlbHits + counters -> dtlbMisses));
+    printf("L1 ITLB hits: %llu\n", counters -> itlbHits);
+    printf("L1 ITLB misses: %llu\n", counters -> itlbMisses);
+    printf("L1 ITLB miss rate: %.3f\n", (float) counters -> itlbMisses / (counters -> itlbHits + counters -> itlbMisses));
+    printf("L2 TLB hits: %llu\n", counters -> l2TlbHits);
+    printf("L2 TLB misses: %llu\n", counters -> l2TlbMisses);
+    printf("L2 TLB miss rate: %.3f\n", (float) counters -> l2TlbMisses / (counters -> l2TlbHits + counters -> l2TlbMisses));
+    printf("Page walks: %llu\n", counters -> pageWalks);
+    if (counters -> walkAccesses)
+    {
+        printf("Page walk accesses: %llu\n", counters -> walkAccesses);
+        printf("Page walk L1 cache hits: %llu\n", counters -> walkL1Hits);
+        printf("Page walk L2 cache hits: %llu\n", counters -> walkL2Hits);
+        printf("Page walk memory reads: %llu\n", counters -> walkMemoryReads);
     }
-    printf("----------------------------------------------------\n");
+}
+
+
+void printDramCounters(const CacheSimDramCounters *counters, const CacheSimConfig *config, unsigned long long int accesses)
+{
+    /* Bandwidth demand is in bytes per interval of accesses; the peak is over whole intervals only */
+    unsigned long long int transfers = counters -> reads + counters -> writes;
+    unsigned long long int bytes = counters -> bytesRead + counters -> bytesWritten;
+
+    printf("DRAM reads: %llu\n", counters -> reads);
+    printf("DRAM writes: %llu\n", counters -> writes);
+    printf("DRAM bytes read: %llu\n", counters -> bytesRead);
+    printf("DRAM bytes written: %llu\n", counters -> bytesWritten);
+    printf("Row buffer hits: %llu\n", counters -> rowHits);
+    printf("Row buffer misses (bank closed): %llu\n", counters -> rowMisses);
+    printf("Row buffer conflicts (other row open): %llu\n", counters -> rowConflicts);
+    printf("Row buffer hit rate: %.3f\n", (float) counters -> rowHits / transfers);
+    printf("DRAM bytes per access: %.3f\n", (double) bytes / accesses);
+    printf("Mean bytes per interval of %lu accesses: %.1f\n", config -> dram.interval, (double) bytes * config -> dram.interval / accesses);
+    printf("Peak bytes per interval of %lu accesses: %llu\n", config -> dram.interval, counters -> peakIntervalBytes);
 }
 
 
 void printUsage()
 {
-    printf("usage: cache-sim l1_cache_size l1_assoc l1_replace_policy l1_block_size l2_cache_size l2_assoc l2_replace_policy l2_block_size trace_file\n");
-    printf("\tl1_cache_size: int - size of L1 cache in bytes; must be a power of 2\n");
+    printf("usage: cache-sim [options] l1_cache_size l1_assoc l1_replace_policy l1_block_size l2_cache_size l2_assoc l2_replace_policy l2_block_size trace_file\n");
+    printf("\tl1_cache_size: int - size of L1 cache in bytes; a power of 2, or a multiple of block size * associativity\n");
     printf("\tl1_assoc: str - associativity of L1 cache; can be one of:\n");
     printf("\t\tdirect - direct mapped cache\n");
     printf("\t\tassoc - fully associative cache\n");
     printf("\t\tassoc:n - n-way associative cache, where n is a power of 2\n");
     printf("\tl1_replace_policy: str - L1 cache replacement policy (lru only is supported)\n");
     printf("\tl1_block_size: int - size of L1 cache block in bytes; must be a power of 2\n");
-    printf("\tl2_cache_size: int - size of L2 cache in bytes; must be a power of 2\n");
+    printf("\tl2_cache_size: int - size of L2 cache in bytes; a power of 2, or a multiple of block size * associativity\n");
     printf("\tl2_assoc: str - associativity of L2 cache; can be one of:\n");
     printf("\t\tdirect - direct mapped cache\n");
     printf("\t\tassoc - fully associative cache\n");
     printf("\t\tassoc:n - n-way associative cache, where n is a power of 2\n");
     printf("\tl2_replace_policy: str - L2 cache replacement policy (lru only is supported)\n");
     printf("\tl2_block_size: int - size of L2 cache block in bytes; must be a power of 2\n");
-    printf("\ttrace_file: str - path to trace file used as input to the simulator\n");
+    printf("\ttrace_file: str - path to trace file used as input to the simulator, or - for standard input\n");
+    printf("options:\n");
+    printf("\t--lackey - the trace is raw output of valgrind --tool=lackey --trace-mem=yes\n");
+    printf("\t--generate spec - simulate a synthetic workload instead of a trace; trace_file is omitted.\n");
+    printf("\t\tspec is pattern[:key=value,...] with pattern seq, strided, random, zipf, chase or matmul\n");
+    printf("\t\tand keys count, footprint, stride, size, base, writes, seed, alpha, n, block (see README)\n");
+    printf("\t--huge-pages - back caches of 2 MB of tags or more with transparent huge pages\n");
+    printf("\t--l1-index function, --l2-index function - set index: modulo (default), xor, prime or skewed\n");
+    printf("\t--l1-victim n, --l2-victim n - add an n-entry fully associative victim cache to the level\n");
+    printf("\t--l1-miss-cache n, --l2-miss-cache n - add an n-entry fully associative miss cache to the level\n");
+    printf("\t--l1-sectors n, --l2-sectors n - divide the level's blocks into n sectors, filled and valid one at a time\n");
+    printf("\t--tenant trace - co-schedule this trace (or gen:spec) with the other tenants; repeat for each, and leave out trace_file\n");
+    printf("\t--weights w0,w1,... - accesses each tenant makes per turn (default 1 each, round robin)\n");
+    printf("\t--partition policy - shared L2 partitioning: none (default), ways:w0,w1,... or ucp[:interval]\n");
+    printf("\t--memo dir - reuse the results stored in dir for the same trace content and configuration, and store new ones\n");
+    printf("\t--tlb d:w,i:w,l:w - model L1 data and instruction TLBs and a shared L2 TLB of the given entries and ways\n");
+    printf("\t--page-size size - TLB page size: 4k (default), 2m or 1g\n");
+    printf("\t--page-walks - read page table entries through the caches on every L2 TLB miss\n");
+    printf("\t--dram c:b[:row[:burst]] - model DRAM behind L2: c channels of b banks, with open rows of row bytes\n");
+    printf("\t\t(default %d) and bursts of burst bytes (default %d); report row buffer locality and bandwidth\n",
+           DRAM_DEFAULT_ROW_SIZE, DRAM_DEFAULT_BURST_SIZE);
+    printf("\t--dram-interval n - accesses per DRAM bandwidth interval (default %d)\n", DRAM_DEFAULT_INTERVAL);
+    printf("\t--filter-l1 file - simulate L1 only and write its misses to file (compressed if it ends in .cst)\n");
+    printf("\t--l2-only - the trace was written by --filter-l1 with the same L1 arguments; simulate L2 only\n");
+    printf("\t--skip n - start at record n of the trace (compressed traces seek without decoding)\n");
+    printf("\t--limit n - simulate at most n records\n");
+    printf("\t--no-readahead - read the trace on the simulation thread\n");
+    printf("\t--profile[=perf] - time the simulator's phases and print accesses per second; perf adds hardware counters\n");
+    printf("\t--reuse - print L1 and L2 reuse-distance histograms (log2 buckets)\n");
+    printf("\t--reuse-window n - track reuse among the last n distinct blocks (default %d)\n", REUSE_DEFAULT_WINDOW / 2);
+    printf("\t--wss file - write the working-set-size curve (blocks and pages per interval) to file\n");
+    printf("\t--wss-interval n - accesses per working-set interval (default %d)\n", WSS_DEFAULT_INTERVAL);
 }
@@ -19,33 +19,108 @@
  * =====================================================================================
  */
 
-typedef struct line Line;
-struct line
-{
-    int valid;
-    unsigned long long int tag;
-    unsigned long int block;
-    unsigned long int usage;
-};
+#ifndef CACHE_SIM_H
+#define CACHE_SIM_H
 
-typedef struct set Set;
-struct set
-{
-    int numItems;
-    Line *lines;
-};
+#include "libcachesim.h"
+
+/* A Line packs everything about one block into 64 bits:
+ *   bits 0-47   tag (tags never exceed 48 bits, see createCache)
+ *   bits 48-61  LRU rank within the Set: 0 is the most recently used
+ *   bit 62      dirty (unused while L1 is write-through)
+ *   bit 63      valid
+ */
+typedef unsigned long long int Line;
+
+#define LINE_TAG_BITS 48
+#define LINE_TAG_MASK ((1ULL << LINE_TAG_BITS) - 1)
+#define LINE_RANK_SHIFT LINE_TAG_BITS
+#define LINE_RANK_BITS 14
+#define LINE_RANK_ONE (1ULL << LINE_RANK_SHIFT)
+#define LINE_RANK_MASK (((1ULL << LINE_RANK_BITS) - 1) << LINE_RANK_SHIFT)
+#define LINE_DIRTY (1ULL << 62)
+#define LINE_VALID (1ULL << 63)
+
+/* The most Lines a Set can hold, so that every rank fits in LINE_RANK_BITS */
+#define MAX_ASSOCIATIVITY (1 << LINE_RANK_BITS)
+
+/* Arenas of at least this many bytes are aligned for, and advised to use, huge pages */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
 typedef struct cache Cache;
 struct cache
 {
-    Set *sets;
+    /* One arena of numSets * numLines Lines; Set i starts at lines[i * numLines].
+     * A Set fills its Lines in order and never invalidates them, so its valid
+     * Lines are always the first numItems[i] */
+    Line *lines;
+    unsigned int *numItems;
     int size;
     int blockSize;
     int associativity;
-    int nSets;
+    /* Geometry derived from the above, assuming 48-bit addresses */
+    int numLines;
+    int numSets;
+    int blockOffsetBits;
+    int setBits;
+    int tagBits;
+    /* Set indexing; see getBlockSet. Other than for a modulo index over a power of 2
+     * sets, the tag is the whole block address, since the set no longer implies its low bits */
+    int indexFunction;
+    int blockTags;
+    int hashBits;
+    int primeSets;
+    /* Skewed-associative caches: the time each Line was last used, for LRU across ways */
+    unsigned long long int *stamps;
+    unsigned long long int clock;
+    /* An optional victim or miss cache: one fully associative Set of block addresses.
+     * victimHit says whether the last miss in this cache was found there */
+    Cache *victim;
+    int missCache;
+    int victimHit;
+    /* Sectored caches: a valid bit per sector of each Line, in a mask beside the arena,
+     * or NULL for whole blocks. sectorSize is what a miss brings in, the block size
+     * if the cache is not sectored. lastLine is the index of the Line the last fetch
+     * hit or filled, and sectorMiss says whether fetchSector found it without the sector */
+    unsigned int *sectors;
+    int sectorSize;
+    int sectorBits;
+    int numSectors;
+    size_t lastLine;
+    int sectorMiss;
+    /* The DRAM behind the last level, which its misses read from, or NULL */
+    struct dram *dram;
 };
 
-int hash(unsigned long long int n, int size)
+static inline int hash(unsigned long long int n, int size)
 {
     return n % size;
 }
+
+/* Cache engine internals, implemented in libcachesim.c */
+int isPowerOfTwo(int n);
+int logBase2(int n);
+Cache *createCache(int size, int associativity, int blockSize, int hugePages, int indexFunction);
+void clearCache(Cache *cache);
+void freeCache(Cache *cache);
+unsigned long long int getTag(unsigned long long int address, int setBits, int tagBits, int blockOffset);
+unsigned long int getSet(unsigned long long int address, int setBits, int tagBits, int blockOffset);
+unsigned long long int getBlockTag(Cache *cache, unsigned long long int address);
+unsigned long int getBlockSet(Cache *cache, unsigned long long int address);
+unsigned long int getSkewedSet(Cache *cache, unsigned long long int block, int way);
+int fetch(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set, int numLines, int numSets);
+void updateLRU(Cache *cache, int tagIndex, int setIndex, int numLines);
+int evict(Cache *cache, unsigned long long int tag, int setIndex, int numLines);
+int fetchSkewed(Cache *cache, int prefetching, unsigned long long int block);
+int sectorCache(Cache *cache, int sectors);
+int fetchSector(Cache *cache, int hit, unsigned long long int address);
+unsigned long long int getLineBlock(Cache *cache, unsigned long long int tag, int setIndex);
+int checkVictim(Cache *cache, unsigned long long int block);
+void fillVictim(Cache *cache, unsigned long long int block);
+void printCache(Cache *cache, int numSets, int numLines);
+
+/* The Cache of a hierarchy level (1 or 2) with or without prefetching, so that
+ * cachesim-verify can compare its contents with the reference engine's */
+Cache *cacheSimGetCache(CacheSim *sim, int level, int prefetching);
+
+#endif
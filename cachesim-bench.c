@@ -0,0 +1,316 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  cachesim-bench.c
+ *
+ *    Description:  Throughput benchmark of the simulation engine. Each workload (a
+ *                  trace file, or a synthetic stream) is decoded into memory first,
+ *                  then replayed through libcachesim for each cache geometry, so the
+ *                  timings cover the engine alone. Results are printed as CSV, or as
+ *                  JSON with -j.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "libcachesim.h"
+#include "synthetic.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Every geometry uses the same sizes; only the associativity changes */
+#define BENCH_L1_SIZE 4096
+#define BENCH_L2_SIZE 65536
+#define BENCH_BLOCK_SIZE 64
+#define BENCH_DEFAULT_ACCESSES 1000000
+
+typedef struct benchGeometry BenchGeometry;
+struct benchGeometry
+{
+    const char *name;
+    int associativity;
+};
+
+static const BenchGeometry geometries[] =
+{
+    { "direct", 1 },
+    { "4-way", 4 },
+    { "8-way", 8 },
+    { "fully-assoc", 0 }
+};
+
+typedef struct benchWorkload BenchWorkload;
+struct benchWorkload
+{
+    const char *name;
+    CacheSimAccess *accesses;
+    size_t numAccesses;
+};
+
+int loadTrace(const char *path, BenchWorkload *workload);
+int loadSynthetic(const char *spec, unsigned long long int numAccesses, BenchWorkload *workload);
+void runWorkload(const BenchWorkload *workload, unsigned long long int minAccesses, int repeats, int json, int *first);
+double now();
+long int peakRSS();
+void printUsage();
+
+int main(int argc, char *argv[])
+{
+    /* Replay each workload until at least this many accesses have been simulated */
+    unsigned long long int minAccesses = BENCH_DEFAULT_ACCESSES;
+    /* Report the fastest of this many runs */
+    int repeats = 1;
+    int json = 0;
+    int synthetic = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:r:js")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                minAccesses = strtoull(optarg, 0, 0);
+                break;
+            case 'r':
+                repeats = atoi(optarg);
+                break;
+            case 'j':
+                json = 1;
+                break;
+            case 's':
+                synthetic = 0;
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+    if (minAccesses == 0 || repeats < 1)
+    {
+        printUsage();
+        return -1;
+    }
+
+    if (json)
+    {
+        printf("[\n");
+    }
+    else
+    {
+        printf("workload,geometry,accesses,seconds,accesses_per_sec,ns_per_access,peak_rss_kb\n");
+    }
+
+    /* Workloads are loaded one at a time, so the peak RSS reflects the largest one */
+    int first = 1;
+    BenchWorkload workload;
+    int i;
+    for (i = optind; i < argc; i++)
+    {
+        if (loadTrace(argv[i], &workload) != 0)
+        {
+            fprintf(stderr, "Error: could not read trace %s.\n", argv[i]);
+            return -1;
+        }
+        runWorkload(&workload, minAccesses, repeats, json, &first);
+        free(workload.accesses);
+    }
+
+    if (synthetic)
+    {
+        /* Streams over the default 16 MB footprint, well beyond L2; a quarter of the accesses are writes */
+        static const char *streams[] = { "seq:writes=0.25", "strided:writes=0.25", "random:writes=0.25" };
+        for (i = 0; i < sizeof(streams) / sizeof(streams[0]); i++)
+        {
+            if (loadSynthetic(streams[i], minAccesses, &workload) != 0)
+            {
+                fprintf(stderr, "Error: invalid synthetic stream %s.\n", streams[i]);
+                return -1;
+            }
+            runWorkload(&workload, minAccesses, repeats, json, &first);
+            free(workload.accesses);
+        }
+    }
+
+    if (json)
+    {
+        printf("\n]\n");
+    }
+
+    return 0;
+}
+
+
+int loadTrace(const char *path, BenchWorkload *workload)
+{
+    /* Decode a whole trace into memory; returns 0 on success, -1 on error */
+    TraceReader *reader = openTrace(path, TRACE_TEXT);
+    if (reader == 0)
+    {
+        return -1;
+    }
+    reader -> splitBlockSize = BENCH_BLOCK_SIZE;
+
+    size_t capacity = 1024;
+    workload -> name = path;
+    workload -> numAccesses = 0;
+    workload -> accesses = malloc(capacity * sizeof(CacheSimAccess));
+    int allocated = workload -> accesses != 0;
+
+    /* Grow through a temporary so the accesses decoded so far can be freed if it fails */
+    CacheSimAccess access;
+    while (allocated && readTrace(reader, &access))
+    {
+        if (workload -> numAccesses == capacity)
+        {
+            CacheSimAccess *grown = realloc(workload -> accesses, 2 * capacity * sizeof(CacheSimAccess));
+            if (grown == 0)
+            {
+                allocated = 0;
+                break;
+            }
+            workload -> accesses = grown;
+            capacity *= 2;
+        }
+        workload -> accesses[workload -> numAccesses++] = access;
+    }
+    closeTrace(reader);
+
+    if (!allocated || workload -> numAccesses == 0)
+    {
+        free(workload -> accesses);
+        return -1;
+    }
+    return 0;
+}
+
+
+int loadSynthetic(const char *spec, unsigned long long int numAccesses, BenchWorkload *workload)
+{
+    /* Generate numAccesses accesses of a synthetic stream into memory; returns 0 on success, -1 on error */
+    char error[128], countedSpec[256];
+    snprintf(countedSpec, sizeof(countedSpec), "%s,count=%llu", spec, numAccesses);
+    SyntheticGenerator *generator = createGenerator(countedSpec, error, sizeof(error));
+    if (generator == 0)
+    {
+        return -1;
+    }
+
+    workload -> name = spec;
+    workload -> numAccesses = 0;
+    workload -> accesses = malloc(numAccesses * sizeof(CacheSimAccess));
+    if (workload -> accesses == 0)
+    {
+        freeGenerator(generator);
+        return -1;
+    }
+    while (workload -> numAccesses < numAccesses && generateAccess(generator, &workload -> accesses[workload -> numAccesses]))
+    {
+        workload -> numAccesses++;
+    }
+    freeGenerator(generator);
+
+    return 0;
+}
+
+
+void runWorkload(const BenchWorkload *workload, unsigned long long int minAccesses, int repeats, int json, int *first)
+{
+    /* Time the workload through every geometry and print one result per geometry */
+    int g, r;
+    for (g = 0; g < sizeof(geometries) / sizeof(geometries[0]); g++)
+    {
+        CacheSimConfig config;
+        memset(&config, 0, sizeof(config));
+        config.l1.size = BENCH_L1_SIZE;
+        config.l1.associativity = geometries[g].associativity;
+        config.l1.blockSize = BENCH_BLOCK_SIZE;
+        config.l2.size = BENCH_L2_SIZE;
+        config.l2.associativity = geometries[g].associativity;
+        config.l2.blockSize = BENCH_BLOCK_SIZE;
+
+        CacheSim *sim = cacheSimCreate(&config);
+        if (sim == 0)
+        {
+            fprintf(stderr, "Error: invalid benchmark geometry %s.\n", geometries[g].name);
+            exit(-1);
+        }
+
+        /* Short traces are replayed, warm, until enough accesses have been simulated */
+        unsigned long long int passes = (minAccesses + workload -> numAccesses - 1) / workload -> numAccesses;
+        unsigned long long int accesses = passes * workload -> numAccesses;
+        double best = 0;
+
+        for (r = 0; r < repeats; r++)
+        {
+            cacheSimReset(sim);
+            double start = now();
+            unsigned long long int p;
+            for (p = 0; p < passes; p++)
+            {
+                cacheSimAccessMany(sim, workload -> accesses, workload -> numAccesses);
+            }
+            double seconds = now() - start;
+            if (r == 0 || seconds < best)
+            {
+                best = seconds;
+            }
+        }
+        cacheSimDestroy(sim);
+
+        double perSecond = best > 0 ? accesses / best : 0;
+        double nsPerAccess = accesses > 0 ? best * 1e9 / accesses : 0;
+
+        if (json)
+        {
+            printf("%s  {\"workload\": \"%s\", \"geometry\": \"%s\", \"accesses\": %llu, \"seconds\": %.6f, "
+                   "\"accesses_per_sec\": %.0f, \"ns_per_access\": %.2f, \"peak_rss_kb\": %ld}",
+                   *first ? "" : ",\n", workload -> name, geometries[g].name, accesses, best,
+                   perSecond, nsPerAccess, peakRSS());
+        }
+        else
+        {
+            printf("%s,%s,%llu,%.6f,%.0f,%.2f,%ld\n", workload -> name, geometries[g].name, accesses, best,
+                   perSecond, nsPerAccess, peakRSS());
+        }
+        fflush(stdout);
+        *first = 0;
+    }
+}
+
+
+double now()
+{
+    /* Monotonic time in seconds */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+long int peakRSS()
+{
+    /* Peak resident set size of the process so far, in KB */
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+
+void printUsage()
+{
+    fprintf(stderr, "usage: cachesim-bench [-n accesses] [-r repeats] [-j] [-s] [trace ...]\n");
+    fprintf(stderr, "\ttrace: str - a trace file to replay (text or compressed)\n");
+    fprintf(stderr, "\t-n accesses: int - replay each workload until at least this many accesses are simulated (default %d)\n",
+            BENCH_DEFAULT_ACCESSES);
+    fprintf(stderr, "\t-r repeats: int - report the fastest of this many runs (default 1)\n");
+    fprintf(stderr, "\t-j - print JSON instead of CSV\n");
+    fprintf(stderr, "\t-s - skip the synthetic streams\n");
+}
@@ -0,0 +1,792 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  cachesim-server.c
+ *
+ *    Description:  Long-lived simulation server. Traces are decoded once and kept in
+ *                  memory; clients connect over a Unix-domain socket and send one
+ *                  request per line, each answered by zero or more "name value"
+ *                  lines and a final OK or ERROR line. Connections are served
+ *                  concurrently by a pool of threads, so several configurations of
+ *                  the same resident trace can be simulated at once.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "dram.h"
+#include "libcachesim.h"
+#include "memo.h"
+#include "synthetic.h"
+#include "trace.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_MAX_TRACES 64
+#define SERVER_MAX_NAME 64
+#define SERVER_QUEUE_LENGTH 64
+#define SERVER_LINE_LENGTH 4096
+
+/* A decoded trace, one access per record operation, not yet split into blocks.
+ * It is freed once it has been unloaded and no simulation is using it */
+typedef struct residentTrace ResidentTrace;
+struct residentTrace
+{
+    char name[SERVER_MAX_NAME];
+    char *path;
+    CacheSimAccess *accesses;
+    size_t numAccesses;
+    int references;
+};
+
+/* Server state shared by every thread */
+typedef struct server Server;
+struct server
+{
+    int listenFd;
+    /* Set by SHUTDOWN on a pool thread, read by the accept loop and the pool */
+    atomic_int stopping;
+    /* Resident traces, guarded by tracesLock */
+    ResidentTrace *traces[SERVER_MAX_TRACES];
+    pthread_mutex_t tracesLock;
+    /* Accepted connections waiting for a thread, guarded by queueLock */
+    int queue[SERVER_QUEUE_LENGTH];
+    int queueHead, queueLength;
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueReady;
+    /* The connection each pool thread is serving, or -1; guarded by queueLock */
+    int *active;
+};
+
+static Server server;
+
+void *serveConnections(void *argument);
+void serveConnection(int fd);
+int handleRequest(char *line, FILE *out);
+int loadTrace(const char *name, const char *path, int format, char *error, size_t errorLength, size_t *numAccesses);
+ResidentTrace *acquireTrace(const char *name);
+void releaseTrace(ResidentTrace *trace);
+int unloadTrace(const char *name);
+int simulateTrace(const ResidentTrace *trace, char **arguments, int numArguments, CacheSimStats *stats,
+                  char *error, size_t errorLength);
+int parseSetting(const char *setting, CacheSimConfig *config);
+int indexFunction(const char *name);
+void printUsage();
+
+int main(int argc, char *argv[])
+{
+    int numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    char *preloads[SERVER_MAX_TRACES];
+    int numPreloads = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "t:l:")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+            case 'l':
+                if (numPreloads < SERVER_MAX_TRACES)
+                {
+                    preloads[numPreloads++] = optarg;
+                }
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+    if (argc - optind != 1 || numThreads < 1)
+    {
+        printUsage();
+        return -1;
+    }
+    const char *socketPath = argv[optind];
+
+    pthread_mutex_init(&server.tracesLock, 0);
+    pthread_mutex_init(&server.queueLock, 0);
+    pthread_cond_init(&server.queueReady, 0);
+    /* A client that hangs up early must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Traces given on the command line, as name=path */
+    int i;
+    char error[256];
+    for (i = 0; i < numPreloads; i++)
+    {
+        char *equals = strchr(preloads[i], '=');
+        size_t numAccesses;
+        if (equals == 0)
+        {
+            fprintf(stderr, "Error: expected name=path, not %s.\n", preloads[i]);
+            return -1;
+        }
+        *equals = '\0';
+        if (loadTrace(preloads[i], equals + 1, TRACE_TEXT, error, sizeof(error), &numAccesses))
+        {
+            fprintf(stderr, "Error: %s\n", error);
+            return -1;
+        }
+        fprintf(stderr, "Loaded %s: %zu accesses\n", preloads[i], numAccesses);
+    }
+
+    /* Listen on the socket, replacing any left behind by an earlier server */
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Error: socket path is too long.\n");
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+    server.listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server.listenFd < 0 || bind(server.listenFd, (struct sockaddr *) &address, sizeof(address)) ||
+        listen(server.listenFd, SERVER_QUEUE_LENGTH))
+    {
+        fprintf(stderr, "Error: could not listen on %s.\n", socketPath);
+        return -1;
+    }
+
+    pthread_t *threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    server.active = (int *) malloc(numThreads * sizeof(int));
+    if (threads == 0 || server.active == 0)
+    {
+        fprintf(stderr, "Error: could not allocate the thread pool.\n");
+        return -1;
+    }
+    for (i = 0; i < numThreads; i++)
+    {
+        server.active[i] = -1;
+        pthread_create(&threads[i], 0, serveConnections, &server.active[i]);
+    }
+    fprintf(stderr, "Listening on %s with %d threads\n", socketPath, numThreads);
+
+    /* Hand each connection to the pool, until a client asks the server to shut down */
+    while (!atomic_load(&server.stopping))
+    {
+        int fd = accept(server.listenFd, 0, 0);
+        if (fd < 0)
+        {
+            continue;
+        }
+        /* The connection SHUTDOWN makes to wake this loop */
+        if (atomic_load(&server.stopping))
+        {
+            close(fd);
+            break;
+        }
+        pthread_mutex_lock(&server.queueLock);
+        if (server.queueLength == SERVER_QUEUE_LENGTH)
+        {
+            pthread_mutex_unlock(&server.queueLock);
+            close(fd);
+            continue;
+        }
+        server.queue[(server.queueHead + server.queueLength++) % SERVER_QUEUE_LENGTH] = fd;
+        pthread_cond_signal(&server.queueReady);
+        pthread_mutex_unlock(&server.queueLock);
+    }
+
+    /* Stop accepting, drop the connections no thread has taken, and let each connection
+     * being served finish the request under way: its client's later requests are not read */
+    close(server.listenFd);
+    unlink(socketPath);
+    pthread_mutex_lock(&server.queueLock);
+    while (server.queueLength)
+    {
+        close(server.queue[server.queueHead]);
+        server.queueHead = (server.queueHead + 1) % SERVER_QUEUE_LENGTH;
+        server.queueLength--;
+    }
+    for (i = 0; i < numThreads; i++)
+    {
+        if (server.active[i] >= 0)
+        {
+            shutdown(server.active[i], SHUT_RD);
+        }
+    }
+    pthread_cond_broadcast(&server.queueReady);
+    pthread_mutex_unlock(&server.queueLock);
+
+    /* Once every thread is done, no simulation holds a trace */
+    for (i = 0; i < numThreads; i++)
+    {
+        pthread_join(threads[i], 0);
+    }
+    for (i = 0; i < SERVER_MAX_TRACES; i++)
+    {
+        if (server.traces[i])
+        {
+            releaseTrace(server.traces[i]);
+        }
+    }
+    free(threads);
+    free(server.active);
+    pthread_mutex_destroy(&server.tracesLock);
+    pthread_mutex_destroy(&server.queueLock);
+    pthread_cond_destroy(&server.queueReady);
+
+    return 0;
+}
+
+
+void *serveConnections(void *argument)
+{
+    /* A pool thread: serve one queued connection at a time, recording it in its slot
+     * of server.active, until the server stops */
+    int *active = (int *) argument;
+    while (1)
+    {
+        pthread_mutex_lock(&server.queueLock);
+        while (server.queueLength == 0 && !atomic_load(&server.stopping))
+        {
+            pthread_cond_wait(&server.queueReady, &server.queueLock);
+        }
+        if (atomic_load(&server.stopping))
+        {
+            pthread_mutex_unlock(&server.queueLock);
+            break;
+        }
+        int fd = server.queue[server.queueHead];
+        server.queueHead = (server.queueHead + 1) % SERVER_QUEUE_LENGTH;
+        server.queueLength--;
+        *active = fd;
+        pthread_mutex_unlock(&server.queueLock);
+
+        serveConnection(fd);
+
+        pthread_mutex_lock(&server.queueLock);
+        *active = -1;
+        pthread_mutex_unlock(&server.queueLock);
+    }
+    return 0;
+}
+
+
+void serveConnection(int fd)
+{
+    /* Answer requests until the client hangs up or sends QUIT */
+    FILE *in = fdopen(fd, "r");
+    FILE *out = fdopen(dup(fd), "w");
+    char *line = (char *) malloc(SERVER_LINE_LENGTH);
+
+    while (in && out && !atomic_load(&server.stopping) && fgets(line, SERVER_LINE_LENGTH, in))
+    {
+        if (handleRequest(line, out))
+        {
+            break;
+        }
+        fflush(out);
+    }
+
+    free(line);
+    if (out)
+    {
+        fclose(out);
+    }
+    if (in)
+    {
+        fclose(in);
+    }
+    else
+    {
+        close(fd);
+    }
+}
+
+
+int handleRequest(char *line, FILE *out)
+{
+    /* Handle one request; returns 1 if the connection should be closed.
+     * Requests:
+     *   LOAD name path [lackey]  decode a trace file (or gen:spec) and keep it as name
+     *   UNLOAD name              forget a trace
+     *   LIST                     name, accesses and path of each resident trace
+     *   SIMULATE name l1_size l1_ways l1_block l2_size l2_ways l2_block [setting=value ...]
+     *                            simulate a configuration; ways are 0 for fully associative
+     *   QUIT                     close the connection
+     *   SHUTDOWN                 stop the server */
+    char *arguments[32];
+    int numArguments = 0;
+    /* Pool threads tokenize concurrently, so keep the position local */
+    char *position;
+    char *token = strtok_r(line, " \t\r\n", &position);
+    while (token && numArguments < 32)
+    {
+        arguments[numArguments++] = token;
+        token = strtok_r(0, " \t\r\n", &position);
+    }
+    if (numArguments == 0)
+    {
+        fprintf(out, "ERROR empty request\n");
+        return 0;
+    }
+
+    char error[256];
+    const char *command = arguments[0];
+    if (!strcmp(command, "LOAD") && (numArguments == 3 || (numArguments == 4 && !strcmp(arguments[3], "lackey"))))
+    {
+        size_t numAccesses;
+        if (loadTrace(arguments[1], arguments[2], numArguments == 4 ? TRACE_LACKEY : TRACE_TEXT, error, sizeof(error), &numAccesses))
+        {
+            fprintf(out, "ERROR %s\n", error);
+        }
+        else
+        {
+            fprintf(out, "accesses %zu\nOK\n", numAccesses);
+        }
+    }
+    else if (!strcmp(command, "UNLOAD") && numArguments == 2)
+    {
+        if (unloadTrace(arguments[1]))
+        {
+            fprintf(out, "ERROR no trace named %s\n", arguments[1]);
+        }
+        else
+        {
+            fprintf(out, "OK\n");
+        }
+    }
+    else if (!strcmp(command, "LIST") && numArguments == 1)
+    {
+        int i;
+        pthread_mutex_lock(&server.tracesLock);
+        for (i = 0; i < SERVER_MAX_TRACES; i++)
+        {
+            if (server.traces[i])
+            {
+                fprintf(out, "%s %zu %s\n", server.traces[i] -> name, server.traces[i] -> numAccesses, server.traces[i] -> path);
+            }
+        }
+        pthread_mutex_unlock(&server.tracesLock);
+        fprintf(out, "OK\n");
+    }
+    else if (!strcmp(command, "SIMULATE") && numArguments >= 8)
+    {
+        ResidentTrace *trace = acquireTrace(arguments[1]);
+        if (trace == 0)
+        {
+            fprintf(out, "ERROR no trace named %s\n", arguments[1]);
+            return 0;
+        }
+
+        CacheSimStats stats;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int status = simulateTrace(trace, arguments + 2, numArguments - 2, &stats, error, sizeof(error));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        releaseTrace(trace);
+
+        if (status)
+        {
+            fprintf(out, "ERROR %s\n", error);
+        }
+        else
+        {
+            char counters[MEMO_STATS_LENGTH];
+            formatStats(counters, sizeof(counters), &stats);
+            fputs(counters, out);
+            fprintf(out, "seconds %.6f\nOK\n", (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        }
+    }
+    else if (!strcmp(command, "QUIT"))
+    {
+        fprintf(out, "OK\n");
+        return 1;
+    }
+    else if (!strcmp(command, "SHUTDOWN"))
+    {
+        /* Wake the accept loop with a connection of our own, so it sees the flag */
+        fprintf(out, "OK\n");
+        fflush(out);
+        atomic_store(&server.stopping, 1);
+        struct sockaddr_un address;
+        socklen_t length = sizeof(address);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && getsockname(server.listenFd, (struct sockaddr *) &address, &length) == 0)
+        {
+            connect(fd, (struct sockaddr *) &address, length);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return 1;
+    }
+    else
+    {
+        fprintf(out, "ERROR unknown or malformed request %s\n", command);
+    }
+
+    return 0;
+}
+
+
+int loadTrace(const char *name, const char *path, int format, char *error, size_t errorLength, size_t *numAccesses)
+{
+    /* Decode a whole trace into memory under name, replacing any trace of that name;
+     * returns 0 on success, -1 on error. Decoding happens outside the lock */
+    if (strlen(name) >= SERVER_MAX_NAME)
+    {
+        snprintf(error, errorLength, "trace name is too long.");
+        return -1;
+    }
+
+    TraceReader *reader;
+    if (!strncmp(path, "gen:", 4))
+    {
+        SyntheticGenerator *generator = createGenerator(path + 4, error, errorLength);
+        reader = generator ? openSyntheticTrace(generator) : 0;
+        if (generator == 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        reader = openTrace(path, format);
+    }
+    if (reader == 0)
+    {
+        snprintf(error, errorLength, "trace file %s not found.", path);
+        return -1;
+    }
+
+    ResidentTrace *trace = (ResidentTrace *) calloc(1, sizeof(ResidentTrace));
+    size_t capacity = 1024;
+    int allocated = trace != 0;
+    if (allocated)
+    {
+        strcpy(trace -> name, name);
+        trace -> path = strdup(path);
+        trace -> references = 1;
+        trace -> accesses = (CacheSimAccess *) malloc(capacity * sizeof(CacheSimAccess));
+        allocated = trace -> path != 0 && trace -> accesses != 0;
+    }
+
+    /* Grow through a temporary so the accesses decoded so far can be freed if it fails */
+    CacheSimAccess access;
+    while (allocated && readTrace(reader, &access))
+    {
+        if (trace -> numAccesses == capacity)
+        {
+            CacheSimAccess *grown = (CacheSimAccess *) realloc(trace -> accesses, 2 * capacity * sizeof(CacheSimAccess));
+            if (grown == 0)
+            {
+                allocated = 0;
+                break;
+            }
+            trace -> accesses = grown;
+            capacity *= 2;
+        }
+        trace -> accesses[trace -> numAccesses++] = access;
+    }
+    closeTrace(reader);
+    if (!allocated)
+    {
+        if (trace)
+        {
+            free(trace -> accesses);
+            free(trace -> path);
+            free(trace);
+        }
+        snprintf(error, errorLength, "could not allocate trace.");
+        return -1;
+    }
+    *numAccesses = trace -> numAccesses;
+
+    /* Take the old trace's slot, or the first free one */
+    int i, slot = -1;
+    ResidentTrace *replaced = 0;
+    pthread_mutex_lock(&server.tracesLock);
+    for (i = 0; i < SERVER_MAX_TRACES; i++)
+    {
+        if (server.traces[i] && !strcmp(server.traces[i] -> name, name))
+        {
+            slot = i;
+            replaced = server.traces[i];
+            break;
+        }
+        if (server.traces[i] == 0 && slot < 0)
+        {
+            slot = i;
+        }
+    }
+    if (slot >= 0)
+    {
+        server.traces[slot] = trace;
+    }
+    pthread_mutex_unlock(&server.tracesLock);
+
+    if (slot < 0)
+    {
+        snprintf(error, errorLength, "at most %d traces can be resident.", SERVER_MAX_TRACES);
+        releaseTrace(trace);
+        return -1;
+    }
+    if (replaced)
+    {
+        releaseTrace(replaced);
+    }
+    return 0;
+}
+
+
+ResidentTrace *acquireTrace(const char *name)
+{
+    /* Find a trace by name and hold a reference to it, or return NULL */
+    ResidentTrace *trace = 0;
+    int i;
+    pthread_mutex_lock(&server.tracesLock);
+    for (i = 0; i < SERVER_MAX_TRACES; i++)
+    {
+        if (server.traces[i] && !strcmp(server.traces[i] -> name, name))
+        {
+            trace = server.traces[i];
+            trace -> references++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&server.tracesLock);
+    return trace;
+}
+
+
+void releaseTrace(ResidentTrace *trace)
+{
+    /* Drop a reference; the last one frees the trace */
+    pthread_mutex_lock(&server.tracesLock);
+    int references = --trace -> references;
+    pthread_mutex_unlock(&server.tracesLock);
+
+    if (references == 0)
+    {
+        free(trace -> accesses);
+        free(trace -> path);
+        free(trace);
+    }
+}
+
+
+int unloadTrace(const char *name)
+{
+    /* Remove a trace from the table, dropping the table's reference; returns -1 if there is none */
+    ResidentTrace *trace = 0;
+    int i;
+    pthread_mutex_lock(&server.tracesLock);
+    for (i = 0; i < SERVER_MAX_TRACES; i++)
+    {
+        if (server.traces[i] && !strcmp(server.traces[i] -> name, name))
+        {
+            trace = server.traces[i];
+            server.traces[i] = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&server.tracesLock);
+
+    if (trace == 0)
+    {
+        return -1;
+    }
+    releaseTrace(trace);
+    return 0;
+}
+
+
+int simulateTrace(const ResidentTrace *trace, char **arguments, int numArguments, CacheSimStats *stats,
+                  char *error, size_t errorLength)
+{
+    /* Simulate the configuration "l1_size l1_ways l1_block l2_size l2_ways l2_block
+     * [setting=value ...]" over a resident trace; returns 0 on success, -1 on error */
+    CacheSimConfig config;
+    memset(&config, 0, sizeof(CacheSimConfig));
+    config.l1.size = atoi(arguments[0]);
+    config.l1.associativity = atoi(arguments[1]);
+    config.l1.blockSize = atoi(arguments[2]);
+    config.l2.size = atoi(arguments[3]);
+    config.l2.associativity = atoi(arguments[4]);
+    config.l2.blockSize = atoi(arguments[5]);
+    config.pageSize = 4096;
+    config.dram.interval = DRAM_DEFAULT_INTERVAL;
+
+    int i;
+    for (i = 6; i < numArguments; i++)
+    {
+        if (parseSetting(arguments[i], &config))
+        {
+            snprintf(error, errorLength, "invalid setting %s", arguments[i]);
+            return -1;
+        }
+    }
+    if (cacheSimCheckConfig(&config, error, errorLength))
+    {
+        return -1;
+    }
+
+    CacheSim *sim = cacheSimCreate(&config);
+    if (sim == 0)
+    {
+        snprintf(error, errorLength, "could not allocate the caches.");
+        return -1;
+    }
+
+    /* An access that straddles L1 blocks touches each of them, as cache-sim reads it */
+    unsigned long long int blockMask = config.l1.blockSize - 1;
+    size_t n;
+    for (n = 0; n < trace -> numAccesses; n++)
+    {
+        const CacheSimAccess *access = &trace -> accesses[n];
+        if (access -> size <= 1)
+        {
+            cacheSimAccess(sim, access -> address, access -> pc, access -> operation);
+            continue;
+        }
+        unsigned long long int cursor = access -> address;
+        unsigned long long int end = access -> address + access -> size - 1;
+        while (1)
+        {
+            cacheSimAccess(sim, cursor, access -> pc, access -> operation);
+            if ((cursor | blockMask) >= end)
+            {
+                break;
+            }
+            cursor = (cursor | blockMask) + 1;
+        }
+    }
+
+    cacheSimGetStats(sim, stats);
+    cacheSimDestroy(sim);
+    return 0;
+}
+
+
+int parseSetting(const char *setting, CacheSimConfig *config)
+{
+    /* Apply one setting=value; returns 0 on success, -1 if it is not recognized */
+    char name[32];
+    int value, length;
+    if (sscanf(setting, "%31[^=]=%n", name, &length) != 1)
+    {
+        return -1;
+    }
+    const char *text = setting + length;
+
+    if (!strcmp(name, "l1index") || !strcmp(name, "l2index"))
+    {
+        value = indexFunction(text);
+        (name[1] == '1' ? &config -> l1 : &config -> l2) -> indexFunction = value;
+        return value < 0 ? -1 : 0;
+    }
+    if (!strcmp(name, "tlb"))
+    {
+        char extra;
+        int ways[6];
+        if (sscanf(text, "%d:%d,%d:%d,%d:%d%c", &ways[0], &ways[1], &ways[2], &ways[3], &ways[4], &ways[5], &extra) != 6)
+        {
+            return -1;
+        }
+        config -> dtlb.entries = ways[0];
+        config -> dtlb.associativity = ways[1];
+        config -> itlb.entries = ways[2];
+        config -> itlb.associativity = ways[3];
+        config -> l2Tlb.entries = ways[4];
+        config -> l2Tlb.associativity = ways[5];
+        return 0;
+    }
+    if (!strcmp(name, "dram"))
+    {
+        /* channels:banks:row_bytes:burst_bytes, all four given */
+        char extra;
+        if (sscanf(text, "%d:%d:%d:%d%c", &config -> dram.channels, &config -> dram.banks, &config -> dram.rowSize,
+                   &config -> dram.burstSize, &extra) != 4)
+        {
+            return -1;
+        }
+        return 0;
+    }
+
+    char *end;
+    value = (int) strtol(text, &end, 10);
+    if (end == text || *end != '\0')
+    {
+        return -1;
+    }
+    if (!strcmp(name, "l1sectors") || !strcmp(name, "l2sectors"))
+    {
+        (name[1] == '1' ? &config -> l1 : &config -> l2) -> sectors = value;
+    }
+    else if (!strcmp(name, "l1victim") || !strcmp(name, "l1miss"))
+    {
+        config -> l1.victimEntries = value;
+        config -> l1.missCache = (name[2] == 'm');
+    }
+    else if (!strcmp(name, "l2victim") || !strcmp(name, "l2miss"))
+    {
+        config -> l2.victimEntries = value;
+        config -> l2.missCache = (name[2] == 'm');
+    }
+    else if (!strcmp(name, "page"))
+    {
+        config -> pageSize = value;
+    }
+    else if (!strcmp(name, "walks"))
+    {
+        config -> pageWalks = value;
+    }
+    else if (!strcmp(name, "draminterval"))
+    {
+        config -> dram.interval = value > 0 ? value : 0;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+
+int indexFunction(const char *name)
+{
+    /* modulo, xor, prime or skewed, as CACHESIM_INDEX_ values; -1 otherwise */
+    static const char *names[] = { "modulo", "xor", "prime", "skewed" };
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        if (!strcmp(name, names[i]))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+void printUsage()
+{
+    fprintf(stderr, "usage: cachesim-server [-t threads] [-l name=trace ...] socket\n");
+    fprintf(stderr, "\tsocket: str - path of the Unix-domain socket to listen on\n");
+    fprintf(stderr, "\t-t threads: int - connections served at once (default: the number of processors)\n");
+    fprintf(stderr, "\t-l name=trace: load a trace file (or gen:spec) before listening\n");
+    fprintf(stderr, "requests, one per line:\n");
+    fprintf(stderr, "\tLOAD name trace [lackey] | UNLOAD name | LIST | QUIT | SHUTDOWN\n");
+    fprintf(stderr, "\tSIMULATE name l1_size l1_ways l1_block l2_size l2_ways l2_block [setting=value ...]\n");
+    fprintf(stderr, "\t\tways: 0 for fully associative; settings: l1index, l2index, l1victim, l2victim,\n");
+    fprintf(stderr, "\t\tl1miss, l2miss, l1sectors, l2sectors, tlb=d:w,i:w,l:w, page, walks,\n");
+    fprintf(stderr, "\t\tdram=channels:banks:row_bytes:burst_bytes, draminterval\n");
+}
@@ -0,0 +1,869 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  cachesim-verify.c
+ *
+ *    Description:  Differential check of the optimized engines against the reference
+ *                  engine (refsim.c). Both run the same trace in lockstep; after every
+ *                  access the sets it touched in each cache are compared, block by
+ *                  block in LRU order, and the first divergence is reported with the
+ *                  access, the set, each side's hit or miss, victim and contents. With
+ *                  -f, geometries and synthetic traces are drawn at random instead.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "cache-sim.h"
+#include "libcachesim.h"
+#include "refsim.h"
+#include "shared.h"
+#include "synthetic.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* The optimized engines */
+/* cacheSimAccess, one access at a time */
+#define ENGINE_ACCESS 0
+/* Runs of one block read by readTraceRun, the repeats added by cacheSimRepeatAccess */
+#define ENGINE_COALESCE 1
+/* cacheSimAccessL1, then cacheSimAccessL2 on another CacheSim for L1 misses, as --filter-l1 and --l2-only */
+#define ENGINE_SPLIT 2
+/* A single tenant of an unpartitioned SharedCache; only the hierarchy without prefetching */
+#define ENGINE_SHARED 3
+#define NUM_ENGINES 4
+
+#define VERIFY_DEFAULT_ACCESSES 20000
+/* Blocks of a set printed in a diagnostic */
+#define VERIFY_PRINT_BLOCKS 16
+
+static const char *engineNames[NUM_ENGINES] = { "access", "coalesce", "split", "shared" };
+static const char *cacheNames[4] = { "L1 without prefetch", "L1 with prefetch", "L2 without prefetch", "L2 with prefetch" };
+
+typedef struct verifyEngine VerifyEngine;
+struct verifyEngine
+{
+    int kind;
+    CacheSim *sim;
+    /* ENGINE_SPLIT: the L2 pass, and the L1 write hits that --filter-l1 keeps as a count */
+    CacheSim *l2Sim;
+    unsigned long long int l1WriteHits;
+    SharedCache *shared;
+    /* L1 and L2 without, then with prefetching; NULL if the engine does not model one */
+    Cache *caches[4];
+};
+
+/* One set of one cache, before and after an access, on both sides */
+typedef struct verifySlot VerifySlot;
+struct verifySlot
+{
+    int cache;
+    unsigned long long int address;
+    unsigned long long int *before[2];
+    unsigned long long int *after[2];
+    int numBefore[2];
+    int numAfter[2];
+};
+
+typedef struct verifySource VerifySource;
+struct verifySource
+{
+    const char *trace;
+    int format;
+    const char *spec;
+};
+
+int verify(const CacheSimConfig *config, const VerifySource *source, int engine, int quiet);
+int createEngine(VerifyEngine *engine, int kind, const CacheSimConfig *config, char *error, size_t errorLength);
+void freeEngine(VerifyEngine *engine);
+int stepEngine(VerifyEngine *engine, const CacheSimAccess *access, unsigned long long int repeats, unsigned long long int writes);
+void getEngineCounters(VerifyEngine *engine, CacheSimStats *stats);
+TraceReader *openSource(const VerifySource *source, int blockSize);
+int getFastBlocks(Cache *cache, unsigned long long int address, unsigned long long int *blocks);
+int getRefBlocks(RefSim *ref, int cache, unsigned long long int address, unsigned long long int *blocks);
+int compareSlot(const VerifySlot *slot);
+void printAccess(const char *engine, unsigned long long int number, const CacheSimAccess *access);
+void printSlot(const VerifySlot *slot, VerifyEngine *engine);
+int compareCounters(const char *engine, const char *hierarchy, const CacheSimCounters *ref, const CacheSimCounters *fast);
+int fuzz(int engine, unsigned long int runs, unsigned long long int seed, unsigned long long int accesses, int verbose);
+unsigned long long int nextRandom(unsigned long long int *state);
+int parseAssociativity(const char *text);
+void formatAssociativity(char *text, size_t length, int associativity);
+void printUsage();
+
+int main(int argc, char *argv[])
+{
+    int engine = -1;
+    int format = TRACE_TEXT;
+    const char *spec = 0;
+    unsigned long int runs = 0;
+    unsigned long long int seed = 1, accesses = VERIFY_DEFAULT_ACCESSES;
+    int verbose = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "e:lg:f:s:n:v")) != -1)
+    {
+        switch (option)
+        {
+            case 'e':
+                for (engine = 0; engine < NUM_ENGINES && strcmp(optarg, engineNames[engine]); engine++)
+                {
+                }
+                if (engine == NUM_ENGINES)
+                {
+                    if (strcmp(optarg, "all"))
+                    {
+                        fprintf(stderr, "Error: unknown engine %s.\n", optarg);
+                        return -1;
+                    }
+                    engine = -1;
+                }
+                break;
+            case 'l':
+                format = TRACE_LACKEY;
+                break;
+            case 'g':
+                spec = optarg;
+                break;
+            case 'f':
+                runs = strtoul(optarg, 0, 10);
+                break;
+            case 's':
+                seed = strtoull(optarg, 0, 0);
+                break;
+            case 'n':
+                accesses = strtoull(optarg, 0, 0);
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+
+    if (runs)
+    {
+        if (optind != argc || accesses == 0)
+        {
+            printUsage();
+            return -1;
+        }
+        return fuzz(engine, runs, seed, accesses, verbose);
+    }
+
+    /* The geometry, then the trace unless it is generated */
+    if (argc - optind != (spec ? 6 : 7))
+    {
+        printUsage();
+        return -1;
+    }
+    argv += optind;
+
+    CacheSimConfig config;
+    memset(&config, 0, sizeof(config));
+    config.l1.size = atoi(argv[0]);
+    config.l1.associativity = parseAssociativity(argv[1]);
+    config.l1.blockSize = atoi(argv[2]);
+    config.l2.size = atoi(argv[3]);
+    config.l2.associativity = parseAssociativity(argv[4]);
+    config.l2.blockSize = atoi(argv[5]);
+
+    VerifySource source;
+    source.trace = spec ? 0 : argv[6];
+    source.format = format;
+    source.spec = spec;
+    if (source.trace && !strcmp(source.trace, "-"))
+    {
+        fprintf(stderr, "Error: the trace is read twice, once for each side, so it cannot be standard input.\n");
+        return -1;
+    }
+
+    int status = 0;
+    int e;
+    for (e = 0; e < NUM_ENGINES && status == 0; e++)
+    {
+        if (engine == -1 || engine == e)
+        {
+            status = verify(&config, &source, e, 0);
+        }
+    }
+
+    return status;
+}
+
+
+int verify(const CacheSimConfig *config, const VerifySource *source, int engine, int quiet)
+{
+    /* Run the reference and engine side by side over source; returns 0 if they agree
+     * throughout, 1 at the first divergence, after printing it, and -1 on error */
+    char error[256];
+    if (cacheSimCheckConfig(config, error, sizeof(error)))
+    {
+        fprintf(stderr, "Error: %s\n", error);
+        return -1;
+    }
+    RefSim *ref = refCreateSim(config);
+    if (ref == 0)
+    {
+        fprintf(stderr, "Error: the reference engine only models power-of-2 geometries with the modulo index.\n");
+        return -1;
+    }
+    /* An engine that cannot model the geometry is skipped */
+    VerifyEngine fast;
+    if (createEngine(&fast, engine, config, error, sizeof(error)))
+    {
+        if (!quiet)
+        {
+            printf("Engine %s: skipped: %s\n", engineNames[engine], error);
+        }
+        refFreeSim(ref);
+        return 0;
+    }
+    TraceReader *refReader = openSource(source, config -> l1.blockSize);
+    TraceReader *fastReader = openSource(source, config -> l1.blockSize);
+    if (refReader == 0 || fastReader == 0)
+    {
+        fprintf(stderr, "Error: could not open %s.\n", source -> trace ? source -> trace : source -> spec);
+        if (refReader)
+        {
+            closeTrace(refReader);
+        }
+        if (fastReader)
+        {
+            closeTrace(fastReader);
+        }
+        freeEngine(&fast);
+        refFreeSim(ref);
+        return -1;
+    }
+    if (engine == ENGINE_COALESCE)
+    {
+        fastReader -> coalesceBlockSize = config -> l1.blockSize;
+    }
+
+    /* The sets an access can touch: its L1 set in each hierarchy, the L2 set of each L2
+     * block the L1 fill reads (several, if L1 blocks are larger), and the set of the block
+     * L2 prefetches. The shared engine has only the hierarchy without prefetching */
+    int maxLines = config -> l1.size / config -> l1.blockSize + config -> l2.size / config -> l2.blockSize;
+    int lookups = (config -> l1.blockSize > config -> l2.blockSize) ? config -> l1.blockSize / config -> l2.blockSize : 1;
+    int hierarchies = (engine == ENGINE_SHARED) ? 1 : 2;
+    int numSlots = hierarchies * (1 + lookups) + (hierarchies - 1);
+    VerifySlot *slots = (VerifySlot *) malloc(numSlots * sizeof(VerifySlot));
+    int i, side;
+    for (i = 0; i < numSlots; i++)
+    {
+        for (side = 0; side < 2; side++)
+        {
+            slots[i].before[side] = (unsigned long long int *) malloc(maxLines * sizeof(unsigned long long int));
+            slots[i].after[side] = (unsigned long long int *) malloc(maxLines * sizeof(unsigned long long int));
+        }
+        /* L1 of each hierarchy, then L2 of each for every lookup, then the prefetch */
+        if (i < hierarchies)
+        {
+            slots[i].cache = i;
+        }
+        else if (i < numSlots - (hierarchies - 1))
+        {
+            slots[i].cache = 2 + (i - hierarchies) % hierarchies;
+        }
+        else
+        {
+            slots[i].cache = 3;
+        }
+    }
+
+    int status = 0;
+    unsigned long long int number = 0;
+    CacheSimAccess access, refAccessRecord;
+    unsigned long long int repeats = 0, writes = 0;
+    while (status == 0)
+    {
+        int more;
+        if (engine == ENGINE_COALESCE)
+        {
+            more = readTraceRun(fastReader, &access, &repeats, &writes);
+        }
+        else
+        {
+            more = readTrace(fastReader, &access);
+        }
+        int refMore = readTrace(refReader, &refAccessRecord);
+        number++;
+        if (!more || !refMore)
+        {
+            if (more != refMore)
+            {
+                printf("Divergence at access %llu (engine %s): the %s reader ended first.\n",
+                       number, engineNames[engine], more ? "reference" : "engine");
+                status = 1;
+            }
+            break;
+        }
+        if (access.address != refAccessRecord.address || access.operation != refAccessRecord.operation || access.pc != refAccessRecord.pc)
+        {
+            printAccess(engineNames[engine], number, &refAccessRecord);
+            printf("  the engine's reader returned %c 0x%llx, pc 0x%llx instead.\n", access.operation, access.address, access.pc);
+            status = 1;
+            break;
+        }
+
+        /* Snapshot the touched sets, run both sides, and snapshot them again */
+        unsigned long long int fill = access.address, prefetch = access.address + config -> l2.blockSize;
+        if (lookups > 1)
+        {
+            fill -= access.address % config -> l1.blockSize;
+            prefetch = fill + config -> l1.blockSize;
+        }
+        for (i = 0; i < numSlots; i++)
+        {
+            if (i < hierarchies)
+            {
+                slots[i].address = access.address;
+            }
+            else if (i < numSlots - (hierarchies - 1))
+            {
+                slots[i].address = fill + (unsigned long long int) ((i - hierarchies) / hierarchies) * config -> l2.blockSize;
+            }
+            else
+            {
+                slots[i].address = prefetch;
+            }
+        }
+        for (i = 0; i < numSlots; i++)
+        {
+            slots[i].numBefore[0] = getRefBlocks(ref, slots[i].cache, slots[i].address, slots[i].before[0]);
+            slots[i].numBefore[1] = getFastBlocks(fast.caches[slots[i].cache], slots[i].address, slots[i].before[1]);
+        }
+
+        int prefetchResult;
+        int refResult = refAccess(ref, access.address, access.operation, &prefetchResult);
+        int fastResult = stepEngine(&fast, &access, repeats, writes);
+
+        for (i = 0; i < numSlots; i++)
+        {
+            slots[i].numAfter[0] = getRefBlocks(ref, slots[i].cache, slots[i].address, slots[i].after[0]);
+            slots[i].numAfter[1] = getFastBlocks(fast.caches[slots[i].cache], slots[i].address, slots[i].after[1]);
+        }
+
+        if (refResult != fastResult)
+        {
+            static const char *results[] = { "memory", "an L1 hit", "an L2 hit" };
+            printAccess(engineNames[engine], number, &access);
+            printf("  the reference found it in %s, the engine in %s.\n", results[refResult],
+                   results[fastResult]);
+            status = 1;
+        }
+        for (i = 0; i < numSlots && status == 0; i++)
+        {
+            if (compareSlot(&slots[i]))
+            {
+                printAccess(engineNames[engine], number, &access);
+                printSlot(&slots[i], &fast);
+                status = 1;
+            }
+        }
+
+        /* The rest of a coalesced run: each access must be an L1 hit in the reference, in the same block */
+        unsigned long long int r, refWrites = 0;
+        for (r = 0; r < repeats && status == 0; r++)
+        {
+            number++;
+            if (!readTrace(refReader, &refAccessRecord))
+            {
+                printf("Divergence at access %llu (engine %s): the engine's run of %llu repeats runs past the end of the trace.\n",
+                       number, engineNames[engine], repeats);
+                status = 1;
+                break;
+            }
+            refResult = refAccess(ref, refAccessRecord.address, refAccessRecord.operation, &prefetchResult);
+            refWrites += (refAccessRecord.operation == 'W');
+            if ((refAccessRecord.address ^ access.address) >= (unsigned long long int) config -> l1.blockSize ||
+                (refAccessRecord.operation != 'R' && refAccessRecord.operation != 'W'))
+            {
+                printAccess(engineNames[engine], number, &refAccessRecord);
+                printf("  the engine's reader folded it into the run of 0x%llx, which is not the same L1 block.\n", access.address);
+                status = 1;
+            }
+            else if (refResult != CACHESIM_L1_HIT || prefetchResult != CACHESIM_L1_HIT)
+            {
+                printAccess(engineNames[engine], number, &refAccessRecord);
+                printf("  the engine counted it as an L1 hit repeating 0x%llx, but the reference did not hit L1.\n", access.address);
+                status = 1;
+            }
+        }
+        if (status == 0 && refWrites != writes)
+        {
+            printAccess(engineNames[engine], number, &access);
+            printf("  the engine counted %llu writes in the run after it, the reference %llu.\n", writes, refWrites);
+            status = 1;
+        }
+    }
+
+    /* The counters must agree as well */
+    if (status == 0)
+    {
+        CacheSimStats fastStats;
+        getEngineCounters(&fast, &fastStats);
+        status = compareCounters(engineNames[engine], "without prefetch", &ref -> stats.noPrefetch, &fastStats.noPrefetch);
+        if (status == 0 && engine != ENGINE_SHARED)
+        {
+            status = compareCounters(engineNames[engine], "with prefetch", &ref -> stats.withPrefetch, &fastStats.withPrefetch);
+        }
+    }
+    if (status == 0 && !quiet)
+    {
+        printf("Engine %s: %llu accesses match the reference.\n", engineNames[engine], ref -> stats.noPrefetch.totalInstructions);
+    }
+
+    for (i = 0; i < numSlots; i++)
+    {
+        for (side = 0; side < 2; side++)
+        {
+            free(slots[i].before[side]);
+            free(slots[i].after[side]);
+        }
+    }
+    free(slots);
+    closeTrace(refReader);
+    closeTrace(fastReader);
+    freeEngine(&fast);
+    refFreeSim(ref);
+
+    return status;
+}
+
+
+int createEngine(VerifyEngine *engine, int kind, const CacheSimConfig *config, char *error, size_t errorLength)
+{
+    /* Returns 0 on success; -1 if the engine cannot model config, with the reason in error */
+    memset(engine, 0, sizeof(VerifyEngine));
+    engine -> kind = kind;
+    if (kind == ENGINE_SHARED)
+    {
+        engine -> shared = createSharedCache(config, 1, PARTITION_NONE, 0, SHARED_DEFAULT_UCP_INTERVAL, error, errorLength);
+        if (engine -> shared == 0)
+        {
+            return -1;
+        }
+        engine -> caches[0] = engine -> shared -> tenants[0].l1;
+        engine -> caches[2] = engine -> shared -> l2;
+        return 0;
+    }
+
+    engine -> sim = cacheSimCreate(config);
+    engine -> caches[0] = cacheSimGetCache(engine -> sim, 1, 0);
+    engine -> caches[1] = cacheSimGetCache(engine -> sim, 1, 1);
+    engine -> caches[2] = cacheSimGetCache(engine -> sim, 2, 0);
+    engine -> caches[3] = cacheSimGetCache(engine -> sim, 2, 1);
+    if (kind == ENGINE_SPLIT)
+    {
+        /* The L1 pass's one L1 stands for both hierarchies' */
+        engine -> l2Sim = cacheSimCreate(config);
+        engine -> caches[1] = engine -> caches[0];
+        engine -> caches[2] = cacheSimGetCache(engine -> l2Sim, 2, 0);
+        engine -> caches[3] = cacheSimGetCache(engine -> l2Sim, 2, 1);
+    }
+
+    return 0;
+}
+
+
+void freeEngine(VerifyEngine *engine)
+{
+    if (engine -> sim)
+    {
+        cacheSimDestroy(engine -> sim);
+    }
+    if (engine -> l2Sim)
+    {
+        cacheSimDestroy(engine -> l2Sim);
+    }
+    if (engine -> shared)
+    {
+        freeSharedCache(engine -> shared);
+    }
+}
+
+
+int stepEngine(VerifyEngine *engine, const CacheSimAccess *access, unsigned long long int repeats, unsigned long long int writes)
+{
+    /* Simulate one access, and any repeats of it; returns where the first was satisfied without prefetching */
+    int result;
+    switch (engine -> kind)
+    {
+        case ENGINE_SPLIT:
+            result = cacheSimAccessL1(engine -> sim, access -> address, access -> pc, access -> operation);
+            if (access -> operation == 'R' || access -> operation == 'W')
+            {
+                if (result != CACHESIM_L1_HIT)
+                {
+                    result = cacheSimAccessL2(engine -> l2Sim, access -> address, access -> pc, access -> operation);
+                }
+                else if (access -> operation == 'W')
+                {
+                    engine -> l1WriteHits++;
+                }
+            }
+            break;
+        case ENGINE_SHARED:
+            result = accessSharedCache(engine -> shared, 0, access -> address, access -> operation);
+            break;
+        default:
+            result = cacheSimAccess(engine -> sim, access -> address, access -> pc, access -> operation);
+            if (repeats)
+            {
+                cacheSimRepeatAccess(engine -> sim, repeats, writes);
+            }
+            break;
+    }
+
+    return result;
+}
+
+
+void getEngineCounters(VerifyEngine *engine, CacheSimStats *stats)
+{
+    if (engine -> kind == ENGINE_SHARED)
+    {
+        memset(stats, 0, sizeof(CacheSimStats));
+        stats -> noPrefetch = engine -> shared -> tenants[0].counters;
+        return;
+    }
+
+    cacheSimGetStats(engine -> sim, stats);
+    if (engine -> kind == ENGINE_SPLIT)
+    {
+        /* Put the counters together as --l2-only does from the filtered trace's metadata */
+        CacheSimStats l1Stats;
+        l1Stats = *stats;
+        cacheSimGetStats(engine -> l2Sim, stats);
+        stats -> noPrefetch.totalInstructions = stats -> withPrefetch.totalInstructions = l1Stats.noPrefetch.totalInstructions;
+        stats -> noPrefetch.l1CacheHits = stats -> withPrefetch.l1CacheHits = l1Stats.noPrefetch.l1CacheHits;
+        stats -> noPrefetch.memoryWrites += engine -> l1WriteHits;
+        stats -> withPrefetch.memoryWrites += engine -> l1WriteHits;
+    }
+}
+
+
+TraceReader *openSource(const VerifySource *source, int blockSize)
+{
+    TraceReader *reader;
+    if (source -> spec)
+    {
+        char error[256];
+        SyntheticGenerator *generator = createGenerator(source -> spec, error, sizeof(error));
+        if (generator == 0)
+        {
+            fprintf(stderr, "Error: %s\n", error);
+            return 0;
+        }
+        reader = openSyntheticTrace(generator);
+    }
+    else
+    {
+        reader = openTrace(source -> trace, source -> format);
+    }
+    /* Straddling accesses are split into one access per L1 block, as cache-sim does */
+    if (reader)
+    {
+        reader -> splitBlockSize = blockSize;
+    }
+
+    return reader;
+}
+
+
+int getFastBlocks(Cache *cache, unsigned long long int address, unsigned long long int *blocks)
+{
+    /* Write the block addresses held by address's Set, most recently used first; returns how many */
+    int setIndex = hash(getBlockSet(cache, address), cache -> numSets);
+    Line *lines = cache -> lines + (size_t) setIndex * cache -> numLines;
+    int numItems = cache -> numItems[setIndex];
+    int i;
+    for (i = 0; i < numItems; i++)
+    {
+        int rank = (lines[i] & LINE_RANK_MASK) >> LINE_RANK_SHIFT;
+        /* A rank outside the valid Lines is itself a divergence; show it as the last block */
+        if (rank >= numItems)
+        {
+            rank = numItems - 1;
+        }
+        blocks[rank] = getLineBlock(cache, lines[i] & LINE_TAG_MASK, setIndex);
+    }
+
+    return numItems;
+}
+
+
+int getRefBlocks(RefSim *ref, int cache, unsigned long long int address, unsigned long long int *blocks)
+{
+    RefCache *caches[4] = { ref -> l1NoPrefetchCache, ref -> l1WithPrefetchCache, ref -> l2NoPrefetchCache, ref -> l2WithPrefetchCache };
+    return refGetSetBlocks(caches[cache], refGetSet(caches[cache], address), blocks);
+}
+
+
+int compareSlot(const VerifySlot *slot)
+{
+    /* Returns 1 if the two sides hold different blocks, or the same blocks in a different order */
+    if (slot -> numAfter[0] != slot -> numAfter[1])
+    {
+        return 1;
+    }
+    return memcmp(slot -> after[0], slot -> after[1], slot -> numAfter[0] * sizeof(unsigned long long int)) != 0;
+}
+
+
+void printAccess(const char *engine, unsigned long long int number, const CacheSimAccess *access)
+{
+    printf("Divergence at access %llu (engine %s): %c 0x%llx, pc 0x%llx\n",
+           number, engine, access -> operation, access -> address, access -> pc);
+}
+
+
+void printSlot(const VerifySlot *slot, VerifyEngine *engine)
+{
+    /* Each side's hit or miss on the set's block, its victim, and its blocks after the access */
+    static const char *sides[2] = { "reference", "engine" };
+    Cache *cache = engine -> caches[slot -> cache];
+    unsigned long long int block = (slot -> address & LINE_TAG_MASK) >> cache -> blockOffsetBits;
+    printf("  %s, set %d, block 0x%llx:\n", cacheNames[slot -> cache], hash(getBlockSet(cache, slot -> address), cache -> numSets),
+           block);
+    int side, i, j;
+    for (side = 0; side < 2; side++)
+    {
+        int hit = 0;
+        unsigned long long int victim = 0;
+        int evicted = 0;
+        for (i = 0; i < slot -> numBefore[side]; i++)
+        {
+            hit |= (slot -> before[side][i] == block);
+            for (j = 0; j < slot -> numAfter[side] && slot -> after[side][j] != slot -> before[side][i]; j++)
+            {
+            }
+            if (j == slot -> numAfter[side])
+            {
+                victim = slot -> before[side][i];
+                evicted = 1;
+            }
+        }
+
+        printf("    %-9s  %s", sides[side], hit ? "hit" : "miss");
+        if (evicted)
+        {
+            printf(", evicted 0x%llx", victim);
+        }
+        printf("; MRU to LRU:");
+        for (i = 0; i < slot -> numAfter[side] && i < VERIFY_PRINT_BLOCKS; i++)
+        {
+            printf(" 0x%llx", slot -> after[side][i]);
+        }
+        if (slot -> numAfter[side] > VERIFY_PRINT_BLOCKS)
+        {
+            printf(" ... (%d blocks)", slot -> numAfter[side]);
+        }
+        printf("\n");
+    }
+
+    /* Long sets are cut short above, so say where they part */
+    for (i = 0; i < slot -> numAfter[0] && i < slot -> numAfter[1] && slot -> after[0][i] == slot -> after[1][i]; i++)
+    {
+    }
+    printf("    first difference at position %d of %d and %d blocks\n", i, slot -> numAfter[0], slot -> numAfter[1]);
+}
+
+
+int compareCounters(const char *engine, const char *hierarchy, const CacheSimCounters *ref, const CacheSimCounters *fast)
+{
+    /* Returns 0 if every counter the reference keeps agrees, 1 after printing the first that does not */
+    static const char *names[] = { "total instructions", "memory reads", "memory writes", "L1 cache hits",
+                                   "L1 cache misses", "L2 cache hits", "L2 cache misses", "overall misses" };
+    unsigned long long int refValues[] = { ref -> totalInstructions, ref -> memoryReads, ref -> memoryWrites, ref -> l1CacheHits,
+                                           ref -> l1CacheMisses, ref -> l2CacheHits, ref -> l2CacheMisses, ref -> overallMisses };
+    unsigned long long int fastValues[] = { fast -> totalInstructions, fast -> memoryReads, fast -> memoryWrites, fast -> l1CacheHits,
+                                            fast -> l1CacheMisses, fast -> l2CacheHits, fast -> l2CacheMisses, fast -> overallMisses };
+    int i;
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (refValues[i] != fastValues[i])
+        {
+            printf("Divergence at the end (engine %s): %s %s is %llu in the reference, %llu in the engine.\n",
+                   engine, hierarchy, names[i], refValues[i], fastValues[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+int fuzz(int engine, unsigned long int runs, unsigned long long int seed, unsigned long long int accesses, int verbose)
+{
+    /* Verify runs random geometries, each over a random synthetic trace; returns 0 if all of them pass */
+    static const char *patterns[] = { "seq", "strided", "random", "zipf", "chase", "matmul" };
+    unsigned long long int state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    unsigned long int run;
+    for (run = 1; run <= runs; run++)
+    {
+        /* A geometry the reference models: power-of-2 sizes, blocks of 4 to 256 bytes,
+         * up to 256 blocks of L1 and 2048 of L2, and up to 64 ways, since every access
+         * compares whole sets */
+        CacheSimConfig config;
+        char error[256];
+        do
+        {
+            memset(&config, 0, sizeof(config));
+            CacheSimLevelConfig *levels[2] = { &config.l1, &config.l2 };
+            int level;
+            for (level = 0; level < 2; level++)
+            {
+                int blockSize = 4 << (nextRandom(&state) % 7);
+                int numBlocks = 1 << (nextRandom(&state) % (level ? 12 : 9));
+                int ways = 1 << (nextRandom(&state) % 7);
+                levels[level] -> blockSize = blockSize;
+                levels[level] -> size = blockSize * numBlocks;
+                /* Direct mapped, fully associative, or n-way */
+                switch (nextRandom(&state) % 4)
+                {
+                    case 0:
+                        levels[level] -> associativity = 1;
+                        break;
+                    case 1:
+                        levels[level] -> associativity = numBlocks <= ways ? 0 : ways;
+                        break;
+                    default:
+                        levels[level] -> associativity = ways < numBlocks ? ways : numBlocks;
+                        break;
+                }
+            }
+        }
+        while (cacheSimCheckConfig(&config, error, sizeof(error)));
+
+        /* A trace over a footprint from 64 bytes to 1 MB, with accesses of 1 to 16 bytes that may straddle blocks */
+        char spec[256];
+        const char *pattern = patterns[nextRandom(&state) % (sizeof(patterns) / sizeof(patterns[0]))];
+        unsigned long long int traceSeed = nextRandom(&state) % 1000000 + 1;
+        if (!strcmp(pattern, "matmul"))
+        {
+            int n = 2 + nextRandom(&state) % 23;
+            int block = 1 << (nextRandom(&state) % 4);
+            snprintf(spec, sizeof(spec), "matmul:n=%d,block=%d,count=%llu", n, block, accesses);
+        }
+        else
+        {
+            int size = 1 << (nextRandom(&state) % 5);
+            unsigned long long int footprint = 64ULL << (nextRandom(&state) % 15);
+            unsigned long long int stride = 1ULL << (2 + nextRandom(&state) % 11);
+            int writes = nextRandom(&state) % 60;
+            if (stride > footprint)
+            {
+                stride = footprint;
+            }
+            snprintf(spec, sizeof(spec), "%s:count=%llu,footprint=%llu,stride=%llu,size=%d,writes=0.%02d,seed=%llu,base=0x%llx",
+                     pattern, accesses, footprint, stride, size, writes, traceSeed,
+                     0x10000000ULL + (nextRandom(&state) % 4096));
+        }
+
+        char l1Associativity[32], l2Associativity[32];
+        formatAssociativity(l1Associativity, sizeof(l1Associativity), config.l1.associativity);
+        formatAssociativity(l2Associativity, sizeof(l2Associativity), config.l2.associativity);
+
+        VerifySource source;
+        source.trace = 0;
+        source.format = TRACE_TEXT;
+        source.spec = spec;
+        int e;
+        for (e = 0; e < NUM_ENGINES; e++)
+        {
+            if (engine != -1 && engine != e)
+            {
+                continue;
+            }
+            if (verbose)
+            {
+                printf("Run %lu: -e %s -g %s %d %s %d %d %s %d\n", run, engineNames[e], spec,
+                       config.l1.size, l1Associativity, config.l1.blockSize, config.l2.size, l2Associativity, config.l2.blockSize);
+                fflush(stdout);
+            }
+            int status = verify(&config, &source, e, 1);
+            if (status)
+            {
+                printf("Run %lu of seed %llu failed; to repeat it:\n", run, seed);
+                printf("  cachesim-verify -e %s -g %s %d %s %d %d %s %d\n", engineNames[e], spec,
+                       config.l1.size, l1Associativity, config.l1.blockSize, config.l2.size, l2Associativity, config.l2.blockSize);
+                return status;
+            }
+        }
+    }
+
+    printf("%lu random runs of seed %llu match the reference.\n", runs, seed);
+    return 0;
+}
+
+
+unsigned long long int nextRandom(unsigned long long int *state)
+{
+    /* xorshift64* */
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+
+int parseAssociativity(const char *text)
+{
+    /* direct, assoc or assoc:n, as for cache-sim; returns -1 if text is none of them */
+    if (!strcmp(text, "direct"))
+    {
+        return 1;
+    }
+    if (!strcmp(text, "assoc"))
+    {
+        return 0;
+    }
+    if (!strncmp(text, "assoc:", 6) && atoi(text + 6) > 0)
+    {
+        return atoi(text + 6);
+    }
+    return -1;
+}
+
+
+void formatAssociativity(char *text, size_t length, int associativity)
+{
+    if (associativity == 1)
+    {
+        snprintf(text, length, "direct");
+    }
+    else if (associativity == 0)
+    {
+        snprintf(text, length, "assoc");
+    }
+    else
+    {
+        snprintf(text, length, "assoc:%d", associativity);
+    }
+}
+
+
+void printUsage()
+{
+    printf("Usage: cachesim-verify [-e engine] [-l] l1_size l1_associativity l1_block_size l2_size l2_associativity l2_block_size trace_file\n");
+    printf("       cachesim-verify [-e engine] -g spec l1_size l1_associativity l1_block_size l2_size l2_associativity l2_block_size\n");
+    printf("       cachesim-verify [-e engine] -f runs [-s seed] [-n accesses] [-v]\n");
+    printf("\t-e engine - access, coalesce, split, shared or all (default)\n");
+    printf("\t-l - the trace is Valgrind Lackey output\n");
+    printf("\t-g spec - a synthetic trace, as for cache-sim --generate\n");
+    printf("\t-f runs - fuzz: verify runs random geometries over random synthetic traces\n");
+    printf("\t-s seed - the fuzzing seed (default 1)\n");
+    printf("\t-n accesses - accesses per fuzzing run (default %d)\n", VERIFY_DEFAULT_ACCESSES);
+    printf("\t-v - print each fuzzing run before it starts\n");
+}
@@ -0,0 +1,105 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  dram.c
+ *
+ *    Description:  Open-page DRAM banks and interval bandwidth counters
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "dram.h"
+#include "cache-sim.h"
+#include <stdlib.h>
+
+
+Dram *createDram(const CacheSimDramConfig *config, CacheSimDramCounters *counters)
+{
+    Dram *dram = (Dram *) calloc(1, sizeof(Dram));
+    if (dram == 0)
+    {
+        return 0;
+    }
+    dram -> rowBits = logBase2(config -> rowSize);
+    dram -> channelBits = logBase2(config -> channels);
+    dram -> bankBits = logBase2(config -> banks);
+    dram -> burstSize = config -> burstSize;
+    dram -> interval = config -> interval;
+    dram -> counters = counters;
+    dram -> openRows = (unsigned long long int *) malloc(sizeof(unsigned long long int) * config -> channels * config -> banks);
+    if (dram -> openRows == 0)
+    {
+        free(dram);
+        return 0;
+    }
+    clearDram(dram);
+    return dram;
+}
+
+
+void accessDram(Dram *dram, unsigned long long int address, int bytes, int write)
+{
+    /* The channel and bank bits above the column index the bank; the rest is the row */
+    unsigned long long int above = address >> dram -> rowBits;
+    unsigned long int bank = above & ((1UL << (dram -> channelBits + dram -> bankBits)) - 1);
+    unsigned long long int row = above >> (dram -> channelBits + dram -> bankBits);
+
+    /* Open page: the row stays open until another row of the bank is needed */
+    if (dram -> openRows[bank] == row)
+    {
+        dram -> counters -> rowHits++;
+    }
+    else
+    {
+        if (dram -> openRows[bank] == DRAM_NO_ROW)
+        {
+            dram -> counters -> rowMisses++;
+        }
+        else
+        {
+            dram -> counters -> rowConflicts++;
+        }
+        dram -> openRows[bank] = row;
+    }
+
+    /* A transfer moves whole bursts */
+    unsigned long long int moved = (bytes + dram -> burstSize - 1) / dram -> burstSize * dram -> burstSize;
+    if (write)
+    {
+        dram -> counters -> writes++;
+        dram -> counters -> bytesWritten += moved;
+    }
+    else
+    {
+        dram -> counters -> reads++;
+        dram -> counters -> bytesRead += moved;
+    }
+    dram -> intervalBytes += moved;
+}
+
+
+void clearDram(Dram *dram)
+{
+    unsigned long int i, numBanks = 1UL << (dram -> channelBits + dram -> bankBits);
+    for (i = 0; i < numBanks; i++)
+    {
+        dram -> openRows[i] = DRAM_NO_ROW;
+    }
+    dram -> intervalAccesses = 0;
+    dram -> intervalBytes = 0;
+}
+
+
+void freeDram(Dram *dram)
+{
+    if (dram == 0)
+    {
+        return;
+    }
+    free(dram -> openRows);
+    free(dram);
+}
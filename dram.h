@@ -0,0 +1,79 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  dram.h
+ *
+ *    Description:  A simple DRAM model behind the last cache level: channels of
+ *                  banks, each with an open row, and the bytes moved per interval
+ *                  of accesses, to judge a configuration by its memory traffic.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef DRAM_H
+#define DRAM_H
+
+#include "libcachesim.h"
+
+/* Defaults for cache-sim's --dram: an 8 KB row and a 64-byte burst, as in DDR4 */
+#define DRAM_DEFAULT_ROW_SIZE 8192
+#define DRAM_DEFAULT_BURST_SIZE 64
+#define DRAM_DEFAULT_INTERVAL 10000
+
+#define DRAM_MAX_CHANNELS 64
+#define DRAM_MAX_BANKS 256
+
+/* The open row of a bank that has none */
+#define DRAM_NO_ROW (~0ULL)
+
+typedef struct dram Dram;
+struct dram
+{
+    /* An address is split, from the low bits up, into the column within a row,
+     * the channel, the bank and the row */
+    int rowBits;
+    int channelBits;
+    int bankBits;
+    int burstSize;
+    /* The row each bank holds open, indexed by its bank and channel bits, or DRAM_NO_ROW */
+    unsigned long long int *openRows;
+    /* Accesses per interval, and the accesses and bytes of the interval under way */
+    unsigned long int interval;
+    unsigned long int intervalAccesses;
+    unsigned long long int intervalBytes;
+    /* Where the transfers are counted */
+    CacheSimDramCounters *counters;
+};
+
+/* Create a DRAM with every bank closed, counting into counters; config must be valid.
+ * Returns NULL if it cannot be allocated */
+Dram *createDram(const CacheSimDramConfig *config, CacheSimDramCounters *counters);
+
+/* Move bytes (rounded up to whole bursts) between DRAM and the block at address */
+void accessDram(Dram *dram, unsigned long long int address, int bytes, int write);
+
+/* Count one access towards the current interval, closing it when it is full */
+static inline void tickDram(Dram *dram)
+{
+    if (++dram -> intervalAccesses == dram -> interval)
+    {
+        if (dram -> intervalBytes > dram -> counters -> peakIntervalBytes)
+        {
+            dram -> counters -> peakIntervalBytes = dram -> intervalBytes;
+        }
+        dram -> counters -> intervals++;
+        dram -> intervalAccesses = 0;
+        dram -> intervalBytes = 0;
+    }
+}
+
+/* Close every bank and start a new interval; the counters are left to the caller */
+void clearDram(Dram *dram);
+
+void freeDram(Dram *dram);
+
+#endif
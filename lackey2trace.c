@@ -0,0 +1,117 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  lackey2trace.c
+ *
+ *    Description:  Convert the output of valgrind --tool=lackey --trace-mem=yes into
+ *                  a cache-sim trace, one record at a time. Replaces the buffering in
+ *                  mem_trace.py: memory use is constant however long the program runs.
+ *                  Also converts existing text traces to the compressed format, and
+ *                  writes out synthetic workloads.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void printUsage();
+
+int main(int argc, char *argv[])
+{
+    /* The lackey output to read ("-" for standard input) and the trace to write */
+    char *inputFile = "-";
+    char *outputFile = "-";
+    int inputFormat = TRACE_LACKEY;
+    int outputFormat = TRACE_TEXT;
+    char *generatorSpec = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "g:o:tz")) != -1)
+    {
+        switch (option)
+        {
+            case 'g':
+                generatorSpec = optarg;
+                break;
+            case 'o':
+                outputFile = optarg;
+                break;
+            case 't':
+                inputFormat = TRACE_TEXT;
+                break;
+            case 'z':
+                outputFormat = TRACE_COMPRESSED;
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+    if (argc - optind > 1)
+    {
+        printUsage();
+        return -1;
+    }
+    if (argc - optind == 1)
+    {
+        inputFile = argv[optind];
+    }
+
+    TraceReader *reader;
+    if (generatorSpec)
+    {
+        char error[128];
+        SyntheticGenerator *generator = createGenerator(generatorSpec, error, sizeof(error));
+        if (generator == 0)
+        {
+            fprintf(stderr, "Error: %s\n", error);
+            return -1;
+        }
+        reader = openSyntheticTrace(generator);
+    }
+    else
+    {
+        reader = openTrace(inputFile, inputFormat);
+    }
+    if (reader == 0)
+    {
+        fprintf(stderr, "Error: input file not found.\n");
+        return -1;
+    }
+    TraceWriter *writer = createTraceWriter(outputFile, outputFormat);
+    if (writer == 0)
+    {
+        fprintf(stderr, "Error: could not open output file.\n");
+        return -1;
+    }
+
+    CacheSimAccess access;
+    while (readTrace(reader, &access))
+    {
+        writeTrace(writer, &access);
+    }
+
+    closeTrace(reader);
+    closeTraceWriter(writer);
+
+    return 0;
+}
+
+
+void printUsage()
+{
+    fprintf(stderr, "usage: lackey2trace [-t] [-z] [-g spec] [-o trace_file] [input]\n");
+    fprintf(stderr, "\tinput: str - output of valgrind --tool=lackey --trace-mem=yes (default: standard input)\n");
+    fprintf(stderr, "\t-t - the input is a cache-sim trace (text or compressed) rather than lackey output\n");
+    fprintf(stderr, "\t-g spec: str - write the synthetic workload spec (see cache-sim --generate) instead of reading input\n");
+    fprintf(stderr, "\t-z - write the compressed trace format instead of text\n");
+    fprintf(stderr, "\t-o trace_file: str - where to write the trace (default: standard output)\n");
+}
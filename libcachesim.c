@@ -0,0 +1,1432 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  libcachesim.c
+ *
+ *    Description:  Cache simulation engine behind the libcachesim API
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "libcachesim.h"
+#include "cache-sim.h"
+#include "dram.h"
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* Page tables live in the top 2 TB of the 48-bit address space, one 512 GB region
+ * per level, so walks do not collide with program data. The entry for a virtual
+ * address at level l (0 is the root) is at
+ *   PAGE_TABLE_BASE + l * PAGE_TABLE_REGION + (address >> (39 - 9 * l)) * 8
+ * which lays each level's tables out in order, as adjacent pages' entries would be */
+#define PAGE_TABLE_BASE 0xfe0000000000ULL
+#define PAGE_TABLE_REGION (1ULL << 39)
+#define PAGE_TABLE_ENTRY_BYTES 8
+
+struct cacheSim
+{
+    CacheSimConfig config;
+    Cache *l1NoPrefetchCache;
+    Cache *l1WithPrefetchCache;
+    Cache *l2NoPrefetchCache;
+    Cache *l2WithPrefetchCache;
+    /* TLBs are caches of page numbers, with one-byte "blocks" */
+    Cache *dtlb;
+    Cache *itlb;
+    Cache *l2Tlb;
+    int pageBits;
+    /* The level of the page table holding leaf entries: 3 for 4 KB pages, 2 for 2 MB, 1 for 1 GB */
+    int leafLevel;
+    CacheSimStats stats;
+    /* Phase timers, or NULL */
+    CacheSimProfile *profile;
+    /* The DRAM behind each hierarchy's L2, or NULL */
+    Dram *noPrefetchDram;
+    Dram *withPrefetchDram;
+};
+
+static int checkLevelConfig(const CacheSimLevelConfig *level, const char *name, char *error, size_t errorLength);
+static int checkTlbConfig(const CacheSimTlbConfig *tlb, const char *name, char *error, size_t errorLength);
+static int checkDramConfig(const CacheSimDramConfig *dram, char *error, size_t errorLength);
+static Cache *createTlb(const CacheSimTlbConfig *tlb);
+static int attachVictim(Cache *cache, const CacheSimLevelConfig *level);
+static inline int lookupTlb(Cache *tlb, unsigned long long int pageNumber);
+static inline void translate(CacheSim *sim, Cache *l1Tlb, unsigned long long int *hits, unsigned long long int *misses,
+                             unsigned long long int address);
+static void walkPageTable(CacheSim *sim, unsigned long long int address);
+static int attachSectors(Cache *cache, const CacheSimLevelConfig *level);
+static inline int fetchBlock(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set,
+                             unsigned long long int address);
+static inline int lookupL2(Cache *l2Cache, CacheSimCounters *counters, unsigned long long int address);
+static inline int accessL2(Cache *l2Cache, CacheSimCounters *counters, int prefetching, unsigned long long int address,
+                           int fillSize);
+static inline int accessHierarchy(Cache *l1Cache, Cache *l2Cache, CacheSimCounters *counters, int prefetching,
+                                  unsigned long long int l1AddressTag, unsigned long int l1AddressSet,
+                                  unsigned long long int address, char operation, CacheSimProfile *profile);
+static inline int simulateAccess(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation,
+                                 CacheSimProfile *profile);
+
+
+int cacheSimCheckConfig(const CacheSimConfig *config, char *error, size_t errorLength)
+{
+    if (checkLevelConfig(&config -> l1, "L1", error, errorLength) ||
+        checkLevelConfig(&config -> l2, "L2", error, errorLength))
+    {
+        return -1;
+    }
+
+    /* TLBs, if any */
+    if (config -> dtlb.entries)
+    {
+        if (checkTlbConfig(&config -> dtlb, "L1 DTLB", error, errorLength) ||
+            checkTlbConfig(&config -> itlb, "L1 ITLB", error, errorLength) ||
+            checkTlbConfig(&config -> l2Tlb, "L2 TLB", error, errorLength))
+        {
+            return -1;
+        }
+        if (config -> pageSize != 4096 && config -> pageSize != 2097152 && config -> pageSize != 1073741824)
+        {
+            snprintf(error, errorLength, "page size must be 4 KB, 2 MB or 1 GB.");
+            return -1;
+        }
+    }
+
+    /* DRAM, if any */
+    if (config -> dram.channels && checkDramConfig(&config -> dram, error, errorLength))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+CacheSim *cacheSimCreate(const CacheSimConfig *config)
+{
+    char error[128];
+    if (cacheSimCheckConfig(config, error, sizeof(error)))
+    {
+        return 0;
+    }
+
+    CacheSim *sim = (CacheSim *) calloc(1, sizeof(CacheSim));
+    if (sim == 0)
+    {
+        return 0;
+    }
+    sim -> config = *config;
+
+    /* A fully associative cache has a single Set holding every block */
+    int l1Ways = config -> l1.associativity ? config -> l1.associativity : config -> l1.size / config -> l1.blockSize;
+    int l2Ways = config -> l2.associativity ? config -> l2.associativity : config -> l2.size / config -> l2.blockSize;
+
+    sim -> l1NoPrefetchCache = createCache(config -> l1.size, l1Ways, config -> l1.blockSize, config -> hugePages, config -> l1.indexFunction);
+    sim -> l1WithPrefetchCache = createCache(config -> l1.size, l1Ways, config -> l1.blockSize, config -> hugePages, config -> l1.indexFunction);
+    sim -> l2NoPrefetchCache = createCache(config -> l2.size, l2Ways, config -> l2.blockSize, config -> hugePages, config -> l2.indexFunction);
+    sim -> l2WithPrefetchCache = createCache(config -> l2.size, l2Ways, config -> l2.blockSize, config -> hugePages, config -> l2.indexFunction);
+    if (!sim -> l1NoPrefetchCache || !sim -> l1WithPrefetchCache || !sim -> l2NoPrefetchCache || !sim -> l2WithPrefetchCache ||
+        attachVictim(sim -> l1NoPrefetchCache, &config -> l1) || attachVictim(sim -> l1WithPrefetchCache, &config -> l1) ||
+        attachVictim(sim -> l2NoPrefetchCache, &config -> l2) || attachVictim(sim -> l2WithPrefetchCache, &config -> l2) ||
+        attachSectors(sim -> l1NoPrefetchCache, &config -> l1) || attachSectors(sim -> l1WithPrefetchCache, &config -> l1) ||
+        attachSectors(sim -> l2NoPrefetchCache, &config -> l2) || attachSectors(sim -> l2WithPrefetchCache, &config -> l2))
+    {
+        cacheSimDestroy(sim);
+        return 0;
+    }
+
+    if (config -> dtlb.entries)
+    {
+        sim -> dtlb = createTlb(&config -> dtlb);
+        sim -> itlb = createTlb(&config -> itlb);
+        sim -> l2Tlb = createTlb(&config -> l2Tlb);
+        if (!sim -> dtlb || !sim -> itlb || !sim -> l2Tlb)
+        {
+            cacheSimDestroy(sim);
+            return 0;
+        }
+        sim -> pageBits = logBase2(config -> pageSize);
+        sim -> leafLevel = (config -> pageSize == 4096) ? 3 : (config -> pageSize == 2097152) ? 2 : 1;
+    }
+
+    if (config -> dram.channels)
+    {
+        sim -> noPrefetchDram = createDram(&config -> dram, &sim -> stats.noPrefetchDram);
+        sim -> withPrefetchDram = createDram(&config -> dram, &sim -> stats.withPrefetchDram);
+        if (!sim -> noPrefetchDram || !sim -> withPrefetchDram)
+        {
+            cacheSimDestroy(sim);
+            return 0;
+        }
+        sim -> l2NoPrefetchCache -> dram = sim -> noPrefetchDram;
+        sim -> l2WithPrefetchCache -> dram = sim -> withPrefetchDram;
+    }
+
+    return sim;
+}
+
+
+int cacheSimAccess(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation)
+{
+    /* Without a profile the timers are compiled out of the inlined copy */
+    if (sim -> profile)
+    {
+        return simulateAccess(sim, address, pc, operation, sim -> profile);
+    }
+    return simulateAccess(sim, address, pc, operation, 0);
+}
+
+
+void cacheSimRepeatAccess(CacheSim *sim, unsigned long long int repeats, unsigned long long int writes)
+{
+    /* A hit on the most recently used Line leaves every rank (and every skewed stamp's order) as it was */
+    sim -> stats.noPrefetch.totalInstructions += repeats;
+    sim -> stats.withPrefetch.totalInstructions += repeats;
+    sim -> stats.noPrefetch.l1CacheHits += repeats;
+    sim -> stats.withPrefetch.l1CacheHits += repeats;
+    /* Writes go through to memory, whether or not they hit */
+    sim -> stats.noPrefetch.memoryWrites += writes;
+    sim -> stats.withPrefetch.memoryWrites += writes;
+}
+
+
+void cacheSimAccessMany(CacheSim *sim, const CacheSimAccess *accesses, size_t n)
+{
+    size_t i;
+    if (sim -> profile)
+    {
+        for (i = 0; i < n; i++)
+        {
+            simulateAccess(sim, accesses[i].address, accesses[i].pc, accesses[i].operation, sim -> profile);
+        }
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        simulateAccess(sim, accesses[i].address, accesses[i].pc, accesses[i].operation, 0);
+    }
+}
+
+
+int cacheSimAccessL1(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation)
+{
+    /* Both hierarchies have the same L1 and see the same accesses, so one L1 stands for both */
+    sim -> stats.noPrefetch.totalInstructions++;
+    sim -> stats.withPrefetch.totalInstructions++;
+
+    if (operation != 'R' && operation != 'W')
+    {
+        return CACHESIM_MEMORY;
+    }
+
+    Cache *l1Cache = sim -> l1NoPrefetchCache;
+    unsigned long long int l1AddressTag = getBlockTag(l1Cache, address);
+    unsigned long int l1AddressSet = getBlockSet(l1Cache, address);
+    if (sim -> profile)
+    {
+        markProfile(sim -> profile, PROFILE_DECODE);
+    }
+    int hit = fetchBlock(l1Cache, 0, l1AddressTag, l1AddressSet, address);
+    if (sim -> profile)
+    {
+        markProfile(sim -> profile, PROFILE_L1);
+    }
+
+    if (hit)
+    {
+        sim -> stats.noPrefetch.l1CacheHits++;
+        sim -> stats.withPrefetch.l1CacheHits++;
+    }
+    else
+    {
+        sim -> stats.noPrefetch.l1CacheMisses++;
+        sim -> stats.withPrefetch.l1CacheMisses++;
+        if (l1Cache -> sectorMiss)
+        {
+            sim -> stats.noPrefetch.l1SectorMisses++;
+            sim -> stats.withPrefetch.l1SectorMisses++;
+        }
+        /* A miss found in the victim cache does not reach L2 either */
+        if (l1Cache -> victimHit)
+        {
+            sim -> stats.noPrefetch.l1VictimHits++;
+            sim -> stats.withPrefetch.l1VictimHits++;
+            hit = 1;
+        }
+    }
+    if (operation == 'W')
+    {
+        sim -> stats.noPrefetch.memoryWrites++;
+        sim -> stats.withPrefetch.memoryWrites++;
+    }
+
+    return hit ? CACHESIM_L1_HIT : CACHESIM_MEMORY;
+}
+
+
+int cacheSimAccessL2(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation)
+{
+    /* DRAM intervals count every access, which a trace of L1 misses does not have */
+    if (sim -> noPrefetchDram)
+    {
+        return -1;
+    }
+
+    sim -> stats.noPrefetch.totalInstructions++;
+    sim -> stats.withPrefetch.totalInstructions++;
+
+    if (operation != 'R' && operation != 'W')
+    {
+        return CACHESIM_MEMORY;
+    }
+
+    sim -> stats.noPrefetch.l1CacheMisses++;
+    sim -> stats.withPrefetch.l1CacheMisses++;
+    /* The filtered trace holds the address of each L1 miss; L2 serves the whole L1 fill */
+    int fillSize = sim -> l1NoPrefetchCache -> sectorSize;
+    int result = accessL2(sim -> l2NoPrefetchCache, &sim -> stats.noPrefetch, 0, address, fillSize);
+    accessL2(sim -> l2WithPrefetchCache, &sim -> stats.withPrefetch, 1, address, fillSize);
+    if (sim -> profile)
+    {
+        markProfile(sim -> profile, PROFILE_L2);
+    }
+    if (operation == 'W')
+    {
+        sim -> stats.noPrefetch.memoryWrites++;
+        sim -> stats.withPrefetch.memoryWrites++;
+    }
+
+    return result;
+}
+
+
+void cacheSimGetStats(const CacheSim *sim, CacheSimStats *stats)
+{
+    *stats = sim -> stats;
+}
+
+
+void cacheSimSetProfile(CacheSim *sim, CacheSimProfile *profile)
+{
+    sim -> profile = profile;
+}
+
+
+Cache *cacheSimGetCache(CacheSim *sim, int level, int prefetching)
+{
+    if (level == 1)
+    {
+        return prefetching ? sim -> l1WithPrefetchCache : sim -> l1NoPrefetchCache;
+    }
+    return prefetching ? sim -> l2WithPrefetchCache : sim -> l2NoPrefetchCache;
+}
+
+
+void cacheSimReset(CacheSim *sim)
+{
+    clearCache(sim -> l1NoPrefetchCache);
+    clearCache(sim -> l1WithPrefetchCache);
+    clearCache(sim -> l2NoPrefetchCache);
+    clearCache(sim -> l2WithPrefetchCache);
+    if (sim -> dtlb)
+    {
+        clearCache(sim -> dtlb);
+        clearCache(sim -> itlb);
+        clearCache(sim -> l2Tlb);
+    }
+    if (sim -> noPrefetchDram)
+    {
+        clearDram(sim -> noPrefetchDram);
+        clearDram(sim -> withPrefetchDram);
+    }
+    memset(&sim -> stats, 0, sizeof(CacheSimStats));
+}
+
+
+void cacheSimDestroy(CacheSim *sim)
+{
+    freeCache(sim -> l1NoPrefetchCache);
+    freeCache(sim -> l1WithPrefetchCache);
+    freeCache(sim -> l2NoPrefetchCache);
+    freeCache(sim -> l2WithPrefetchCache);
+    freeCache(sim -> dtlb);
+    freeCache(sim -> itlb);
+    freeCache(sim -> l2Tlb);
+    freeDram(sim -> noPrefetchDram);
+    freeDram(sim -> withPrefetchDram);
+    free(sim);
+}
+
+
+static int checkLevelConfig(const CacheSimLevelConfig *level, const char *name, char *error, size_t errorLength)
+{
+    /* Block Size */
+    /* Must be a positive power of 2, less than or equal to the cache size */
+    if (level -> size <= 0 || level -> blockSize <= 0 || level -> blockSize > level -> size || !isPowerOfTwo(level -> blockSize))
+    {
+        snprintf(error, errorLength, "%s block size must be a positive power of 2, <= to %s cache size.", name, name);
+        return -1;
+    }
+
+    /* Associativity */
+    /* Either fully associative (0) or a positive power of 2 no larger than the number of blocks */
+    if (level -> associativity < 0 || (level -> associativity > 0 && !isPowerOfTwo(level -> associativity)))
+    {
+        snprintf(error, errorLength, "invalid %s cache associativity.", name);
+        return -1;
+    }
+    if (level -> associativity > level -> size / level -> blockSize)
+    {
+        snprintf(error, errorLength, "%s associativity exceeds the number of %s cache blocks.", name, name);
+        return -1;
+    }
+    /* A Line's LRU rank has room for MAX_ASSOCIATIVITY ways */
+    int ways = level -> associativity ? level -> associativity : level -> size / level -> blockSize;
+    if (ways > MAX_ASSOCIATIVITY)
+    {
+        snprintf(error, errorLength, "%s cache has more than %d ways.", name, MAX_ASSOCIATIVITY);
+        return -1;
+    }
+
+    /* Cache Size */
+    /* A power of 2, or else a whole number of sets of ways blocks */
+    if (!isPowerOfTwo(level -> size) && level -> size % (level -> blockSize * ways) != 0)
+    {
+        snprintf(error, errorLength, "%s cache size must be a power of 2, or a multiple of block size * associativity.", name);
+        return -1;
+    }
+
+    /* Index Function */
+    if (level -> indexFunction < CACHESIM_INDEX_MODULO || level -> indexFunction > CACHESIM_INDEX_SKEWED)
+    {
+        snprintf(error, errorLength, "invalid %s cache index function.", name);
+        return -1;
+    }
+
+    /* Victim Cache */
+    /* One fully associative Set, so it has the same limit on ways */
+    if (level -> victimEntries < 0 || level -> victimEntries > MAX_ASSOCIATIVITY)
+    {
+        snprintf(error, errorLength, "%s victim cache entries must be between 0 and %d.", name, MAX_ASSOCIATIVITY);
+        return -1;
+    }
+
+    /* Sectors */
+    /* A power of 2 up to the bits of a sector mask and the bytes of a block; a victim
+     * cache holds whole blocks, so it cannot sit beside a sectored level */
+    if (level -> sectors < 0 || level -> sectors > 32 || (level -> sectors > 1 && !isPowerOfTwo(level -> sectors)) ||
+        level -> sectors > level -> blockSize)
+    {
+        snprintf(error, errorLength, "%s sectors must be a power of 2, at most 32 and at most the block size.", name);
+        return -1;
+    }
+    if (level -> sectors > 1 && level -> victimEntries)
+    {
+        snprintf(error, errorLength, "%s cache cannot be both sectored and have a victim or miss cache.", name);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static int checkTlbConfig(const CacheSimTlbConfig *tlb, const char *name, char *error, size_t errorLength)
+{
+    /* Entries */
+    /* Must be a positive power of 2 */
+    if (tlb -> entries <= 0 || !isPowerOfTwo(tlb -> entries))
+    {
+        snprintf(error, errorLength, "%s entries must be a power of 2.", name);
+        return -1;
+    }
+
+    /* Associativity */
+    /* Either fully associative (0) or a power of 2 no larger than the number of entries */
+    if (tlb -> associativity < 0 || (tlb -> associativity > 0 && !isPowerOfTwo(tlb -> associativity)) ||
+        tlb -> associativity > tlb -> entries)
+    {
+        snprintf(error, errorLength, "invalid %s associativity.", name);
+        return -1;
+    }
+    if ((tlb -> associativity ? tlb -> associativity : tlb -> entries) > MAX_ASSOCIATIVITY)
+    {
+        snprintf(error, errorLength, "%s has more than %d ways.", name, MAX_ASSOCIATIVITY);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static int checkDramConfig(const CacheSimDramConfig *dram, char *error, size_t errorLength)
+{
+    if (dram -> channels < 0 || dram -> channels > DRAM_MAX_CHANNELS || !isPowerOfTwo(dram -> channels))
+    {
+        snprintf(error, errorLength, "DRAM channels must be a power of 2, at most %d.", DRAM_MAX_CHANNELS);
+        return -1;
+    }
+    if (dram -> banks <= 0 || dram -> banks > DRAM_MAX_BANKS || !isPowerOfTwo(dram -> banks))
+    {
+        snprintf(error, errorLength, "DRAM banks must be a power of 2, at most %d.", DRAM_MAX_BANKS);
+        return -1;
+    }
+    if (dram -> burstSize <= 0 || !isPowerOfTwo(dram -> burstSize))
+    {
+        snprintf(error, errorLength, "DRAM burst size must be a power of 2.");
+        return -1;
+    }
+    if (dram -> rowSize < dram -> burstSize || !isPowerOfTwo(dram -> rowSize))
+    {
+        snprintf(error, errorLength, "DRAM row size must be a power of 2, at least the burst size.");
+        return -1;
+    }
+    if (dram -> interval == 0)
+    {
+        snprintf(error, errorLength, "DRAM bandwidth interval must be nonzero.");
+        return -1;
+    }
+    return 0;
+}
+
+
+static Cache *createTlb(const CacheSimTlbConfig *tlb)
+{
+    /* A TLB is a Cache whose "addresses" are page numbers, each one byte long */
+    int ways = tlb -> associativity ? tlb -> associativity : tlb -> entries;
+    return createCache(tlb -> entries, ways, 1, 0, CACHESIM_INDEX_MODULO);
+}
+
+
+static int attachVictim(Cache *cache, const CacheSimLevelConfig *level)
+{
+    /* Give cache the victim or miss cache of its level, if any; returns -1 if it cannot be allocated.
+     * It is a single fully associative Set, so its tags are block addresses */
+    if (level -> victimEntries == 0)
+    {
+        return 0;
+    }
+    cache -> victim = createCache(level -> victimEntries * level -> blockSize, level -> victimEntries, level -> blockSize,
+                                  0, CACHESIM_INDEX_MODULO);
+    cache -> missCache = level -> missCache != 0;
+    return cache -> victim ? 0 : -1;
+}
+
+
+static int attachSectors(Cache *cache, const CacheSimLevelConfig *level)
+{
+    /* Divide cache's Lines into the sectors of its level, if any; returns -1 if the masks cannot be allocated */
+    if (level -> sectors <= 1)
+    {
+        return 0;
+    }
+    return sectorCache(cache, level -> sectors);
+}
+
+
+static inline int lookupTlb(Cache *tlb, unsigned long long int pageNumber)
+{
+    /* Returns 1 on a hit; a miss installs the translation */
+    unsigned long long int tag = getBlockTag(tlb, pageNumber);
+    unsigned long int set = getBlockSet(tlb, pageNumber);
+    return fetch(tlb, 0, tag, set, tlb -> numLines, tlb -> numSets);
+}
+
+
+static inline void translate(CacheSim *sim, Cache *l1Tlb, unsigned long long int *hits, unsigned long long int *misses,
+                             unsigned long long int address)
+{
+    /* Look the page up in an L1 TLB, then in the L2 TLB, then walk the page table */
+    unsigned long long int pageNumber = (address & LINE_TAG_MASK) >> sim -> pageBits;
+
+    if (lookupTlb(l1Tlb, pageNumber))
+    {
+        (*hits)++;
+        return;
+    }
+    (*misses)++;
+
+    if (lookupTlb(sim -> l2Tlb, pageNumber))
+    {
+        sim -> stats.tlb.l2TlbHits++;
+        return;
+    }
+    sim -> stats.tlb.l2TlbMisses++;
+    sim -> stats.tlb.pageWalks++;
+
+    if (sim -> config.pageWalks)
+    {
+        walkPageTable(sim, address);
+    }
+}
+
+
+static void walkPageTable(CacheSim *sim, unsigned long long int address)
+{
+    /* Read one entry per level, from the root down to the leaf, through both hierarchies.
+     * The hierarchy without prefetching reports into the TLB counters; the other one's
+     * counts are dropped, as the walk is not part of the trace */
+    CacheSimCounters noPrefetch, withPrefetch;
+    memset(&noPrefetch, 0, sizeof(CacheSimCounters));
+    memset(&withPrefetch, 0, sizeof(CacheSimCounters));
+
+    address &= LINE_TAG_MASK;
+    Cache *l1Cache = sim -> l1NoPrefetchCache;
+    int level;
+    for (level = 0; level <= sim -> leafLevel; level++)
+    {
+        unsigned long long int entry = PAGE_TABLE_BASE + level * PAGE_TABLE_REGION +
+                                       (address >> (39 - 9 * level)) * PAGE_TABLE_ENTRY_BYTES;
+        unsigned long long int l1AddressTag = getBlockTag(l1Cache, entry);
+        unsigned long int l1AddressSet = getBlockSet(l1Cache, entry);
+
+        accessHierarchy(sim -> l1NoPrefetchCache, sim -> l2NoPrefetchCache, &noPrefetch, 0, l1AddressTag, l1AddressSet, entry, 'R', 0);
+        accessHierarchy(sim -> l1WithPrefetchCache, sim -> l2WithPrefetchCache, &withPrefetch, 1, l1AddressTag, l1AddressSet, entry, 'R', 0);
+    }
+
+    sim -> stats.tlb.walkAccesses += noPrefetch.l1CacheHits + noPrefetch.l1CacheMisses;
+    sim -> stats.tlb.walkL1Hits += noPrefetch.l1CacheHits + noPrefetch.l1VictimHits;
+    sim -> stats.tlb.walkL2Hits += noPrefetch.l2CacheHits + noPrefetch.l2VictimHits;
+    sim -> stats.tlb.walkMemoryReads += noPrefetch.memoryReads;
+}
+
+
+static inline int fetchBlock(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set,
+                             unsigned long long int address)
+{
+    /* fetch, and in a sectored cache, the sector of address within the Line */
+    int hit = fetch(cache, prefetching, tag, set, cache -> numLines, cache -> numSets);
+    if (cache -> sectors)
+    {
+        hit = fetchSector(cache, hit, address);
+    }
+    return hit;
+}
+
+
+static inline int lookupL2(Cache *l2Cache, CacheSimCounters *counters, unsigned long long int address)
+{
+    /* Look up the L2 block (or sector) of address for an L1 fill; returns CACHESIM_L2_HIT,
+     * or CACHESIM_MEMORY if it is read from memory. A miss that the victim cache serves
+     * is an L2 hit here, but is counted as an L2 miss */
+    unsigned long long int l2AddressTag = getBlockTag(l2Cache, address);
+    unsigned long int l2AddressSet = getBlockSet(l2Cache, address);
+
+    int hit = fetchBlock(l2Cache, 0, l2AddressTag, l2AddressSet, address);
+
+    /* If L2 Cache Hit */
+    if (hit)
+    {
+        counters -> l2CacheHits++;
+        return CACHESIM_L2_HIT;
+    }
+
+    /* If L2 Cache Miss */
+    counters -> l2CacheMisses++;
+    if (l2Cache -> sectorMiss)
+    {
+        counters -> l2SectorMisses++;
+    }
+    /* The victim cache may still hold the block */
+    if (l2Cache -> victimHit)
+    {
+        counters -> l2VictimHits++;
+        return CACHESIM_L2_HIT;
+    }
+    counters -> memoryReads++;
+    if (l2Cache -> dram)
+    {
+        accessDram(l2Cache -> dram, address, l2Cache -> sectorSize, 0);
+    }
+    return CACHESIM_MEMORY;
+}
+
+
+static inline int accessL2(Cache *l2Cache, CacheSimCounters *counters, int prefetching, unsigned long long int address,
+                           int fillSize)
+{
+    /* Returns where an access that missed in L1 was satisfied.
+     * L1 brings in fillSize bytes (a block or a sector). If that is no more than L2
+     * brings in, the one L2 block or sector holding address serves it; otherwise L2
+     * is looked up for each of its blocks or sectors the fill covers, in order */
+    unsigned long long int hitsBefore = counters -> l2CacheHits;
+    int lookups = 1;
+    int result;
+    if (fillSize <= l2Cache -> sectorSize)
+    {
+        result = lookupL2(l2Cache, counters, address);
+    }
+    else
+    {
+        address &= ~(unsigned long long int) (fillSize - 1);
+        lookups = fillSize >> l2Cache -> sectorBits;
+        result = CACHESIM_L2_HIT;
+        int i;
+        for (i = 0; i < lookups; i++)
+        {
+            if (lookupL2(l2Cache, counters, address + ((unsigned long long int) i << l2Cache -> sectorBits)) == CACHESIM_MEMORY)
+            {
+                result = CACHESIM_MEMORY;
+            }
+        }
+    }
+    if (result == CACHESIM_MEMORY)
+    {
+        counters -> overallMisses++;
+    }
+
+    /* Prefetch when L2 missed (even if its victim cache had the block) */
+    if (prefetching && counters -> l2CacheHits - hitsBefore < (unsigned long long int) lookups)
+    {
+        /* Get the new address: the block (or sector) after the last one read */
+        address += (unsigned long long int) lookups << l2Cache -> sectorBits;
+        /* Get the Tag and the Set from the new Address */
+        unsigned long long int l2AddressTag = getBlockTag(l2Cache, address);
+        unsigned long int l2AddressSet = getBlockSet(l2Cache, address);
+
+        int hit = fetchBlock(l2Cache, 1, l2AddressTag, l2AddressSet, address);
+
+        /* If Cache Miss, the prefetched block is read from memory, unless the victim cache has it */
+        if (!hit && !l2Cache -> victimHit)
+        {
+            counters -> memoryReads++;
+            if (l2Cache -> dram)
+            {
+                accessDram(l2Cache -> dram, address, l2Cache -> sectorSize, 0);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+static inline int accessHierarchy(Cache *l1Cache, Cache *l2Cache, CacheSimCounters *counters, int prefetching,
+                                  unsigned long long int l1AddressTag, unsigned long int l1AddressSet,
+                                  unsigned long long int address, char operation, CacheSimProfile *profile)
+{
+    /* Returns where the access was satisfied */
+    int result;
+
+    /* Check L1 cache */
+    int hit = fetchBlock(l1Cache, 0, l1AddressTag, l1AddressSet, address);
+    if (profile)
+    {
+        markProfile(profile, PROFILE_L1);
+    }
+
+    /* If L1 Cache Hit */
+    if (hit)
+    {
+        counters -> l1CacheHits++;
+        result = CACHESIM_L1_HIT;
+    }
+    /* If L1 Cache Miss */
+    else
+    {
+        counters -> l1CacheMisses++;
+        if (l1Cache -> sectorMiss)
+        {
+            counters -> l1SectorMisses++;
+        }
+        /* A block found in the victim cache is swapped back into L1 without going to L2 */
+        if (l1Cache -> victimHit)
+        {
+            counters -> l1VictimHits++;
+            result = CACHESIM_L1_HIT;
+        }
+        else
+        {
+            result = accessL2(l2Cache, counters, prefetching, address, l1Cache -> sectorSize);
+            if (profile)
+            {
+                markProfile(profile, PROFILE_L2);
+            }
+        }
+    }
+
+    /* Writes go through to memory, whether or not they hit; DRAM takes each one as a burst */
+    if (operation == 'W')
+    {
+        counters -> memoryWrites++;
+        if (l2Cache -> dram)
+        {
+            accessDram(l2Cache -> dram, address, 1, 1);
+        }
+    }
+
+    return result;
+}
+
+
+static inline void tickDrams(CacheSim *sim)
+{
+    /* Count an access towards both DRAM intervals once its traffic has been added */
+    if (sim -> noPrefetchDram)
+    {
+        tickDram(sim -> noPrefetchDram);
+        tickDram(sim -> withPrefetchDram);
+    }
+}
+
+
+static inline int simulateAccess(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation,
+                                 CacheSimProfile *profile)
+{
+    sim -> stats.noPrefetch.totalInstructions++;
+    sim -> stats.withPrefetch.totalInstructions++;
+
+    /* Only Reads and Writes touch the caches */
+    if (operation != 'R' && operation != 'W')
+    {
+        tickDrams(sim);
+        return CACHESIM_MEMORY;
+    }
+
+    /* Translate the instruction's address, then the data address; a page walk's
+     * reads reach the caches before the access that caused them */
+    if (sim -> dtlb)
+    {
+        if (pc)
+        {
+            translate(sim, sim -> itlb, &sim -> stats.tlb.itlbHits, &sim -> stats.tlb.itlbMisses, pc);
+        }
+        translate(sim, sim -> dtlb, &sim -> stats.tlb.dtlbHits, &sim -> stats.tlb.dtlbMisses, address);
+        if (profile)
+        {
+            markProfile(profile, PROFILE_TLB);
+        }
+    }
+
+    /* Get the Tag and the Set from the Address */
+    Cache *l1Cache = sim -> l1NoPrefetchCache;
+    unsigned long long int l1AddressTag = getBlockTag(l1Cache, address);
+    unsigned long int l1AddressSet = getBlockSet(l1Cache, address);
+    if (profile)
+    {
+        markProfile(profile, PROFILE_DECODE);
+    }
+
+    int result = accessHierarchy(sim -> l1NoPrefetchCache, sim -> l2NoPrefetchCache, &sim -> stats.noPrefetch, 0,
+                                 l1AddressTag, l1AddressSet, address, operation, profile);
+    accessHierarchy(sim -> l1WithPrefetchCache, sim -> l2WithPrefetchCache, &sim -> stats.withPrefetch, 1,
+                    l1AddressTag, l1AddressSet, address, operation, profile);
+    tickDrams(sim);
+
+    return result;
+}
+
+
+Cache *createCache(int size, int associativity, int blockSize, int hugePages, int indexFunction)
+{
+    /* The Cache contains a table of Sets, each numLines Lines of one contiguous arena.
+     * A Line packs the validity of the current block, its tag and its LRU rank (see cache-sim.h).
+     * Assume all addresses will be 48 bits.
+     * To index:
+     * The Block Offset (number of bits) is given by log2(cacheBlockSize); discard these bits on the right
+     * The Set bits are given by log2(numSets); use these bits on the left
+     * The Tag (number of bits) is given by the number of bits in the address (48) - Block Offset bits - Set bits
+     */
+
+    /* Assume addresses are 48 bits */
+    int addressLength = 48;
+
+    Cache *cache = (Cache *) malloc(sizeof(Cache));
+    if (cache == 0)
+    {
+        return 0;
+    }
+    cache -> size = size;
+    cache -> blockSize = blockSize;
+    cache -> associativity = associativity;
+    /* Determine the number of Lines per Set */
+    cache -> numLines = associativity;
+    /* Determine the number of Sets in the Cache */
+    cache -> numSets = size / (blockSize * associativity);
+    /* Determine the number of bits for the Block Offset, the Set and the Tag */
+    cache -> blockOffsetBits = logBase2(blockSize);
+    cache -> setBits = logBase2(cache -> numSets);
+    cache -> tagBits = addressLength - cache -> blockOffsetBits - cache -> setBits;
+
+    /* Any index but a modulo over a power of 2 needs the whole block address as the tag
+     * (at most 48 bits, so it still fits in a Line), and hashes fold it to hashBits */
+    cache -> indexFunction = indexFunction;
+    cache -> hashBits = 0;
+    while ((1 << cache -> hashBits) < cache -> numSets)
+    {
+        cache -> hashBits++;
+    }
+    cache -> blockTags = (indexFunction != CACHESIM_INDEX_MODULO || !isPowerOfTwo(cache -> numSets));
+    if (cache -> blockTags)
+    {
+        cache -> tagBits = addressLength - cache -> blockOffsetBits;
+    }
+    /* The largest prime no larger than the number of Sets */
+    cache -> primeSets = cache -> numSets;
+    while (cache -> primeSets > 2)
+    {
+        int divisor = 2;
+        while (divisor * divisor <= cache -> primeSets && cache -> primeSets % divisor != 0)
+        {
+            divisor++;
+        }
+        if (divisor * divisor > cache -> primeSets)
+        {
+            break;
+        }
+        cache -> primeSets--;
+    }
+
+    /* Allocate every Set's Lines in one arena, aligned to a cache line, or to a huge
+     * page if the arena is large enough to use them */
+    size_t bytes = (size_t) cache -> numSets * cache -> numLines * sizeof(Line);
+    size_t alignment = 64;
+    if (hugePages && bytes >= HUGE_PAGE_SIZE)
+    {
+        alignment = HUGE_PAGE_SIZE;
+        bytes = (bytes + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+    }
+    if (posix_memalign((void **) &cache -> lines, alignment, bytes))
+    {
+        free(cache);
+        return 0;
+    }
+#ifdef MADV_HUGEPAGE
+    if (alignment == HUGE_PAGE_SIZE)
+    {
+        madvise(cache -> lines, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    cache -> numItems = (unsigned int *) malloc(cache -> numSets * sizeof(unsigned int));
+    cache -> stamps = 0;
+    cache -> victim = 0;
+    cache -> missCache = 0;
+    cache -> victimHit = 0;
+    cache -> sectors = 0;
+    cache -> sectorSize = blockSize;
+    cache -> sectorBits = cache -> blockOffsetBits;
+    cache -> numSectors = 1;
+    cache -> lastLine = 0;
+    cache -> sectorMiss = 0;
+    cache -> dram = 0;
+    if (indexFunction == CACHESIM_INDEX_SKEWED)
+    {
+        cache -> stamps = (unsigned long long int *) malloc((size_t) cache -> numSets * cache -> numLines * sizeof(unsigned long long int));
+    }
+    if (cache -> numItems == 0 || (indexFunction == CACHESIM_INDEX_SKEWED && cache -> stamps == 0))
+    {
+        freeCache(cache);
+        return 0;
+    }
+    clearCache(cache);
+
+    return cache;
+}
+
+
+void clearCache(Cache *cache)
+{
+    /* Invalidate every Line */
+    memset(cache -> lines, 0, (size_t) cache -> numSets * cache -> numLines * sizeof(Line));
+    memset(cache -> numItems, 0, cache -> numSets * sizeof(unsigned int));
+    if (cache -> stamps)
+    {
+        memset(cache -> stamps, 0, (size_t) cache -> numSets * cache -> numLines * sizeof(unsigned long long int));
+    }
+    cache -> clock = 0;
+    if (cache -> victim)
+    {
+        clearCache(cache -> victim);
+    }
+    cache -> victimHit = 0;
+    if (cache -> sectors)
+    {
+        memset(cache -> sectors, 0, (size_t) cache -> numSets * cache -> numLines * sizeof(unsigned int));
+    }
+    cache -> sectorMiss = 0;
+}
+
+
+void freeCache(Cache *cache)
+{
+    if (cache == 0)
+    {
+        return;
+    }
+
+    /* Free the arena of Lines, then the Set fill counts, stamps, sector masks and victim cache, then the Cache struct */
+    free(cache -> lines);
+    free(cache -> numItems);
+    free(cache -> stamps);
+    free(cache -> sectors);
+    freeCache(cache -> victim);
+    free(cache);
+}
+
+
+int isPowerOfTwo(int n)
+{
+    /* Return 0 if n is not a power of 2, 1 otherwise */
+
+    /* If n is 0, n is not a power of 2 */
+    if (n == 0)
+    {
+        return 0;
+    }
+    /* Continue dividing n by 2 until a remainder is found (return 0) or n is 1 (return 1) */
+    while (n != 1)
+    {
+        /* If a remainder is found, n is not a power of 2 */
+        if (n % 2 != 0)
+        {
+            return 0;
+        }
+        /* Divide n by 2 */
+        n = n / 2;
+    }
+
+    /* Here, n must be a power of 2 */
+    return 1;
+}
+
+
+
+int logBase2(int n)
+{
+    /* Continue shifting right until n is 0 */
+    int log = 0;
+    while (n - 1 > 0)
+    {
+        n = n >> 1;
+        log++;
+    }
+
+    return log;
+}
+
+
+unsigned long long int getTag(unsigned long long int address, int setBits, int tagBits, int blockOffset)
+{
+    /* The mask that will be used to get the ith bit */
+    unsigned long long int mask = 1;
+    
+    /* Shift address right by blockOffset and setBits */
+    address = address >> (blockOffset + setBits);
+
+    /* For each bit after the blockOffset and setBits */
+    unsigned long long int tag = 0;
+    int i;
+    for (i = 0; i < tagBits; i++)
+    {
+        /* AND the ith bit of address with mask, and add it to tag */
+        tag += address & mask;
+
+        /* printf("Tag %d, Address & Mask %lu\n", tag, address & mask); */
+
+        /* Shift mask left */
+        mask = mask << 1;
+    }
+
+    return tag;
+}
+
+
+unsigned long int getSet(unsigned long long int address, int setBits, int tagBits, int blockOffset)
+{
+    /* The mask that will be used to get the ith bit */
+    unsigned long long int mask = 1;
+    
+    /* Shift address right by blockOffset */
+    address = address >> blockOffset;
+
+    /* For each bit after the blockOffset */
+    unsigned long int set = 0;
+    int i;
+    for (i = 0; i < setBits; i++)
+    {
+        /* AND the ith bit of address with mask, and add it to set */
+        set += address & mask;
+
+        /* printf("Set %d, Address & Mask %lu\n", set, address & mask); */
+
+        /* Shift mask left */
+        mask = mask << 1;
+    }
+
+    return set;
+}
+
+
+unsigned long long int getBlockTag(Cache *cache, unsigned long long int address)
+{
+    /* The conventional split keeps the bits above the Set bits; every other index keeps the block address */
+    if (!cache -> blockTags)
+    {
+        return getTag(address, cache -> setBits, cache -> tagBits, cache -> blockOffsetBits);
+    }
+    return (address & LINE_TAG_MASK) >> cache -> blockOffsetBits;
+}
+
+
+unsigned long int getBlockSet(Cache *cache, unsigned long long int address)
+{
+    /* Map an address to its Set with the cache's index function. Skewed caches use the
+     * XOR fold here; fetchSkewed hashes again per way */
+    unsigned long long int block = (address & LINE_TAG_MASK) >> cache -> blockOffsetBits;
+    unsigned long long int folded = 0;
+
+    switch (cache -> indexFunction)
+    {
+        case CACHESIM_INDEX_XOR:
+        case CACHESIM_INDEX_SKEWED:
+            /* XOR together successive hashBits-wide fields of the block address */
+            if (cache -> hashBits == 0)
+            {
+                return 0;
+            }
+            while (block)
+            {
+                folded ^= block & ((1ULL << cache -> hashBits) - 1);
+                block >>= cache -> hashBits;
+            }
+            return folded % cache -> numSets;
+
+        case CACHESIM_INDEX_PRIME:
+            return block % cache -> primeSets;
+
+        default:
+            /* The low Set bits; the same as a modulo when the number of Sets is a power of 2 */
+            if (!cache -> blockTags)
+            {
+                return getSet(address, cache -> setBits, cache -> tagBits, cache -> blockOffsetBits);
+            }
+            return block % cache -> numSets;
+    }
+}
+
+
+unsigned long int getSkewedSet(Cache *cache, unsigned long long int block, int way)
+{
+    /* Way 0 uses the XOR fold; every other way scrambles the block address with its own
+     * multiplier first, so blocks that conflict in one way are spread out in the others */
+    if (way == 0)
+    {
+        return getBlockSet(cache, block << cache -> blockOffsetBits);
+    }
+    unsigned long long int x = block ^ (way * 0x9e3779b97f4a7c15ULL);
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 31;
+    return x % cache -> numSets;
+}
+
+
+int fetch(Cache *cache, int prefetching, unsigned long long int tag, unsigned long int set, int numLines, int numSets)
+{
+    /* Return 1 on a Cache Hit, 0 on a Cache Miss */
+    int hit = 0;
+
+    /* A skewed cache has no single Set to search; its tag is the block address */
+    if (cache -> indexFunction == CACHESIM_INDEX_SKEWED)
+    {
+        return fetchSkewed(cache, prefetching, tag);
+    }
+
+    /* Hash the Set, and find its Lines in the arena */
+    int setIndex = hash(set, numSets);
+    Line *lines = cache -> lines + (size_t) setIndex * numLines;
+    unsigned int numItems = cache -> numItems[setIndex];
+    int tagIndex = 0;
+
+    /* printf("Tag is %llx. Indexing Set %d\n", tag, setIndex); */
+    /* Compare the new Tag against each valid Line in the Set; the valid Lines are the first numItems */
+    Line wanted = LINE_VALID | tag;
+    unsigned int i;
+    for (i = 0; i < numItems; i++)
+    {
+        /* If the Valid bit is 1 and the Tag at i matches the new Tag, Cache Hit */
+        if ((lines[i] & (LINE_VALID | LINE_TAG_MASK)) == wanted)
+        {
+            /* printf("HIT\n"); */
+            hit = 1;
+            tagIndex = i;
+            break;
+        }
+    }
+
+    /* If no matches are found, Cache Miss */
+    if (!hit)
+    {
+        /* printf("MISS\n"); */
+
+        /* Look in the victim cache before the block is brought in, which may evict into it */
+        if (cache -> victim)
+        {
+            cache -> victimHit = checkVictim(cache, getLineBlock(cache, tag, setIndex));
+        }
+
+        /* If Set is not full */
+        if (numItems < numLines)
+        {
+            /* Bring new address into the Cache, write into the next empty Line.
+             * It starts as the least recently used, so updateLRU ages every other Line */
+            tagIndex = numItems;
+            lines[tagIndex] = LINE_VALID | ((Line) numItems << LINE_RANK_SHIFT) | tag;
+            cache -> numItems[setIndex]++;
+        }
+        /* If Set is full */
+        else
+        {
+            /* Evict LRU from cache and bring address into cache */
+            tagIndex = evict(cache, tag, setIndex, numLines);
+        }
+    }
+
+    if (!prefetching || !hit)
+    {
+        /* Update the blocks' Least Recently Used properties */
+        updateLRU(cache, tagIndex, setIndex, numLines);
+    }
+    cache -> lastLine = (size_t) setIndex * numLines + tagIndex;
+
+    return hit;
+}
+
+
+void updateLRU(Cache *cache, int tagIndex, int setIndex, int numLines)
+{
+    /* Assume that the block at [setIndex][tagIndex] has been used.
+     * Every Line more recently used than it ages by one rank, and it becomes the most recently used. */
+    Line *lines = cache -> lines + (size_t) setIndex * numLines;
+    unsigned int numItems = cache -> numItems[setIndex];
+    Line rank = lines[tagIndex] & LINE_RANK_MASK;
+    unsigned int i;
+    for (i = 0; i < numItems; i++)
+    {
+        /* Only the used Line has this rank, so it is never aged */
+        if ((lines[i] & LINE_RANK_MASK) < rank)
+        {
+            lines[i] += LINE_RANK_ONE;
+        }
+    }
+    lines[tagIndex] &= ~LINE_RANK_MASK;
+}
+
+
+int evict(Cache *cache, unsigned long long int tag, int setIndex, int numLines)
+{
+    /* Find the Least Recently Used block and replace it with the given block */
+    Line *lines = cache -> lines + (size_t) setIndex * numLines;
+    Line lruRank = (Line) (numLines - 1) << LINE_RANK_SHIFT;
+    int indexOfLRU = 0;
+    int i;
+
+    for (i = 0; i < numLines; i++)
+    {
+        if ((lines[i] & LINE_RANK_MASK) == lruRank)
+        {
+            indexOfLRU = i;
+            break;
+        }
+    }
+
+    /* printf("Evicting %llx\n", lines[indexOfLRU] & LINE_TAG_MASK); */
+    /* A victim cache keeps the evicted block */
+    if (cache -> victim && !cache -> missCache)
+    {
+        fillVictim(cache, getLineBlock(cache, lines[indexOfLRU] & LINE_TAG_MASK, setIndex));
+    }
+    /* The new block keeps the LRU rank until updateLRU makes it the most recently used */
+    lines[indexOfLRU] = LINE_VALID | lruRank | tag;
+
+    return indexOfLRU;
+}
+
+
+int fetchSkewed(Cache *cache, int prefetching, unsigned long long int block)
+{
+    /* Return 1 on a Cache Hit, 0 on a Cache Miss.
+     * Way w of a skewed-associative cache can only hold block in Set getSkewedSet(block, w),
+     * so there is one candidate Line per way. A miss fills an empty candidate if there is
+     * one, and otherwise the least recently used candidate */
+    int numLines = cache -> numLines;
+    Line wanted = LINE_VALID | block;
+    size_t index, victim = 0;
+    unsigned long long int oldest = ~0ULL;
+    int way;
+
+    for (way = 0; way < numLines; way++)
+    {
+        index = (size_t) getSkewedSet(cache, block, way) * numLines + way;
+
+        /* If the Valid bit is 1 and the Tag matches, Cache Hit */
+        if ((cache -> lines[index] & (LINE_VALID | LINE_TAG_MASK)) == wanted)
+        {
+            if (!prefetching)
+            {
+                cache -> stamps[index] = ++cache -> clock;
+            }
+            cache -> lastLine = index;
+            return 1;
+        }
+
+        /* Invalid Lines have a stamp of 0, so they are chosen before any valid one */
+        if (cache -> stamps[index] < oldest)
+        {
+            oldest = cache -> stamps[index];
+            victim = index;
+        }
+    }
+
+    /* Cache Miss: check the victim cache, then bring the block into the victim Line, as the most recently used */
+    if (cache -> victim)
+    {
+        cache -> victimHit = checkVictim(cache, block);
+        if (!cache -> missCache && (cache -> lines[victim] & LINE_VALID))
+        {
+            fillVictim(cache, cache -> lines[victim] & LINE_TAG_MASK);
+        }
+    }
+    cache -> lines[victim] = wanted;
+    cache -> stamps[victim] = ++cache -> clock;
+    cache -> lastLine = victim;
+
+    return 0;
+}
+
+
+int sectorCache(Cache *cache, int sectors)
+{
+    /* Give each Line of cache a valid bit per sector, all clear; returns -1 if the masks cannot be allocated */
+    cache -> sectors = (unsigned int *) calloc((size_t) cache -> numSets * cache -> numLines, sizeof(unsigned int));
+    if (cache -> sectors == 0)
+    {
+        return -1;
+    }
+    cache -> numSectors = sectors;
+    cache -> sectorSize = cache -> blockSize / sectors;
+    cache -> sectorBits = logBase2(cache -> sectorSize);
+    return 0;
+}
+
+
+int fetchSector(Cache *cache, int hit, unsigned long long int address)
+{
+    /* Return 1 if the Line fetch just hit or filled holds the sector of address, 0 otherwise.
+     * A Line fetch brought in holds only that sector. A Line that was present gains the
+     * sector, and the miss is a sector miss: nothing is evicted and LRU is as fetch left it */
+    unsigned int sector = 1U << ((address >> cache -> sectorBits) & (cache -> numSectors - 1));
+    unsigned int *valid = &cache -> sectors[cache -> lastLine];
+
+    cache -> sectorMiss = 0;
+    if (!hit)
+    {
+        *valid = sector;
+        return 0;
+    }
+    if (*valid & sector)
+    {
+        return 1;
+    }
+    *valid |= sector;
+    cache -> sectorMiss = 1;
+    return 0;
+}
+
+
+unsigned long long int getLineBlock(Cache *cache, unsigned long long int tag, int setIndex)
+{
+    /* The block address of a Line: its tag, or its tag above its Set bits */
+    if (cache -> blockTags)
+    {
+        return tag;
+    }
+    return (tag << cache -> setBits) | setIndex;
+}
+
+
+int checkVictim(Cache *cache, unsigned long long int block)
+{
+    /* Return 1 if the victim or miss cache of cache holds block, 0 otherwise.
+     * A victim cache gives the block up, as it moves back into cache; a miss cache
+     * keeps its copy, and takes a copy of every block it did not have */
+    Cache *victim = cache -> victim;
+    Line *lines = victim -> lines;
+    unsigned int numItems = victim -> numItems[0];
+    Line wanted = LINE_VALID | block;
+    unsigned int i;
+
+    for (i = 0; i < numItems; i++)
+    {
+        if ((lines[i] & (LINE_VALID | LINE_TAG_MASK)) == wanted)
+        {
+            break;
+        }
+    }
+
+    if (i == numItems)
+    {
+        if (cache -> missCache)
+        {
+            fetch(victim, 0, block, 0, victim -> numLines, 1);
+        }
+        return 0;
+    }
+
+    if (cache -> missCache)
+    {
+        updateLRU(victim, i, 0, victim -> numLines);
+        return 1;
+    }
+
+    /* Remove the Line, keeping the valid Lines a prefix and their ranks 0 to numItems - 1:
+     * the last valid Line takes its place, and every less recently used Line moves up a rank */
+    Line rank = lines[i] & LINE_RANK_MASK;
+    unsigned int j;
+    for (j = 0; j < numItems; j++)
+    {
+        if ((lines[j] & LINE_RANK_MASK) > rank)
+        {
+            lines[j] -= LINE_RANK_ONE;
+        }
+    }
+    lines[i] = lines[numItems - 1];
+    lines[numItems - 1] = 0;
+    victim -> numItems[0]--;
+
+    return 1;
+}
+
+
+void fillVictim(Cache *cache, unsigned long long int block)
+{
+    /* Put a block evicted from cache into its victim cache, as the most recently used */
+    Cache *victim = cache -> victim;
+    fetch(victim, 0, block, 0, victim -> numLines, 1);
+}
+
+
+void printCache(Cache *cache, int numSets, int numLines)
+{
+    Line currentLine;
+
+    printf("----------------------------------------------------\n");
+    int i, j;
+    for (i = 0; i < numSets; i++)
+    {
+        printf("Set %d:\n", i);
+        for (j = 0; j < numLines; j++)
+        {
+            currentLine = cache -> lines[(size_t) i * numLines + j];
+
+            printf("\tLine %d: Valid - %d | Tag - %llx | Rank - %d\n", j, (currentLine & LINE_VALID) != 0,
+                   currentLine & LINE_TAG_MASK, (int) ((currentLine & LINE_RANK_MASK) >> LINE_RANK_SHIFT));
+        }
+    }
+    printf("----------------------------------------------------\n");
+}
+
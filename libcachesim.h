@@ -0,0 +1,244 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  libcachesim.h
+ *
+ *    Description:  Public C API of the cache simulation engine. A CacheSim models
+ *                  an L1-L2 hierarchy twice, with and without next-block L2
+ *                  prefetching, exactly as the cache-sim command line tool does.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef LIBCACHESIM_H
+#define LIBCACHESIM_H
+
+#include <stddef.h>
+
+/* Where an access was satisfied in the hierarchy without prefetching */
+#define CACHESIM_MEMORY 0
+#define CACHESIM_L1_HIT 1
+#define CACHESIM_L2_HIT 2
+
+/* How a cache level maps a block to a set */
+/* The block address modulo the number of sets: the low bits, for a power of 2 */
+#define CACHESIM_INDEX_MODULO 0
+/* All the block address bits, XOR-folded down to the set bits */
+#define CACHESIM_INDEX_XOR 1
+/* The block address modulo the largest prime <= the number of sets; the sets above it go unused */
+#define CACHESIM_INDEX_PRIME 2
+/* Skewed-associative: each way indexes its sets with a different hash */
+#define CACHESIM_INDEX_SKEWED 3
+
+typedef struct cacheSimLevelConfig CacheSimLevelConfig;
+struct cacheSimLevelConfig
+{
+    /* The total size of the cache in bytes; a power of 2, or any multiple of
+     * blockSize * associativity for a number of sets that is not a power of 2 */
+    int size;
+    /* The number of ways: 1 for direct mapped, 0 for fully associative, n for n-way;
+     * at most 16384 either way */
+    int associativity;
+    /* The size of a cache block in bytes; must be a power of 2, <= size. The levels'
+     * block sizes may differ: an L1 miss reads each L2 block (or sector) that the L1
+     * fill covers, so one L2 block can serve several L1 misses, and an L1 block larger
+     * than L2's takes several L2 lookups */
+    int blockSize;
+    /* One of the CACHESIM_INDEX_ functions; 0 is the conventional modulo index */
+    int indexFunction;
+    /* The number of blocks in a small fully associative buffer beside the level, or 0
+     * for none. It is checked on every miss before the next level. As a victim cache
+     * it holds the blocks the level evicts, and a hit swaps the block back in; if
+     * missCache is nonzero it is a miss cache instead, holding a copy of every block
+     * the level fills */
+    int victimEntries;
+    int missCache;
+    /* The number of sectors each block is divided into, each with its own valid bit,
+     * or 0 (or 1) for whole blocks. A miss brings in only the sector accessed, so a
+     * Line whose tag is present may still miss on another sector; that is filled
+     * without evicting anything. A power of 2, at most 32 and at most blockSize, and
+     * not combined with a victim or miss cache */
+    int sectors;
+};
+
+typedef struct cacheSimTlbConfig CacheSimTlbConfig;
+struct cacheSimTlbConfig
+{
+    /* The number of translations held; a power of 2, or 0 for no TLB */
+    int entries;
+    /* The number of ways, as for a cache level */
+    int associativity;
+};
+
+typedef struct cacheSimDramConfig CacheSimDramConfig;
+struct cacheSimDramConfig
+{
+    /* The number of channels, or 0 for no DRAM model; a power of 2, at most 64 */
+    int channels;
+    /* The number of banks in each channel; a power of 2, at most 256 */
+    int banks;
+    /* The bytes of one row of a bank, which its row buffer holds open; a power of 2 */
+    int rowSize;
+    /* The bytes of one burst, the smallest transfer; a power of 2, at most rowSize */
+    int burstSize;
+    /* The accesses in each bandwidth interval; nonzero */
+    unsigned long int interval;
+};
+
+typedef struct cacheSimConfig CacheSimConfig;
+struct cacheSimConfig
+{
+    CacheSimLevelConfig l1;
+    CacheSimLevelConfig l2;
+    /* If nonzero, back large caches' tag arenas with transparent huge pages */
+    int hugePages;
+    /* Optional TLBs in front of the hierarchy: data and instruction L1 TLBs and a
+     * shared L2 TLB. Translation is modelled when dtlb.entries is nonzero; data
+     * accesses look up dtlb, and the PC of each access (if nonzero) looks up itlb */
+    CacheSimTlbConfig dtlb;
+    CacheSimTlbConfig itlb;
+    CacheSimTlbConfig l2Tlb;
+    /* 4096, 2097152 or 1073741824 bytes */
+    int pageSize;
+    /* If nonzero, each L2 TLB miss reads the page table entries of an x86-64 style
+     * radix walk through the data caches */
+    int pageWalks;
+    /* Optional DRAM behind L2, one per hierarchy, modelled when dram.channels is nonzero.
+     * Every memory read and write is a transfer to the bank its address maps to:
+     * within a row, the column bits come lowest, then the channel, the bank and the
+     * row. Each bank keeps its last row open (an open-page policy) */
+    CacheSimDramConfig dram;
+};
+
+typedef struct cacheSimAccess CacheSimAccess;
+struct cacheSimAccess
+{
+    unsigned long long int address;
+    unsigned long long int pc;
+    /* 'R' or 'W'; any other operation is counted but not simulated */
+    char operation;
+    /* The number of bytes accessed, or 0 if the trace does not record it */
+    int size;
+};
+
+typedef struct cacheSimCounters CacheSimCounters;
+struct cacheSimCounters
+{
+    unsigned long long int totalInstructions;
+    unsigned long long int memoryReads;
+    unsigned long long int memoryWrites;
+    unsigned long long int l1CacheHits;
+    unsigned long long int l1CacheMisses;
+    unsigned long long int l2CacheHits;
+    unsigned long long int l2CacheMisses;
+    /* The misses of each level served by its victim or miss cache, so not passed on */
+    unsigned long long int l1VictimHits;
+    unsigned long long int l2VictimHits;
+    /* The misses of each level on a Line that was present without the sector accessed */
+    unsigned long long int l1SectorMisses;
+    unsigned long long int l2SectorMisses;
+    /* The accesses whose L1 fill read memory, once each however many L2 lookups the
+     * fill took; the misses of the hierarchy as a whole */
+    unsigned long long int overallMisses;
+};
+
+typedef struct cacheSimTlbCounters CacheSimTlbCounters;
+struct cacheSimTlbCounters
+{
+    unsigned long long int dtlbHits;
+    unsigned long long int dtlbMisses;
+    unsigned long long int itlbHits;
+    unsigned long long int itlbMisses;
+    unsigned long long int l2TlbHits;
+    unsigned long long int l2TlbMisses;
+    unsigned long long int pageWalks;
+    /* Page table entry reads, and how the hierarchy without prefetching served them */
+    unsigned long long int walkAccesses;
+    unsigned long long int walkL1Hits;
+    unsigned long long int walkL2Hits;
+    unsigned long long int walkMemoryReads;
+};
+
+typedef struct cacheSimDramCounters CacheSimDramCounters;
+struct cacheSimDramCounters
+{
+    /* Transfers from and to DRAM, and their bytes, rounded up to whole bursts */
+    unsigned long long int reads;
+    unsigned long long int writes;
+    unsigned long long int bytesRead;
+    unsigned long long int bytesWritten;
+    /* How each transfer found its bank: with its row open, with no row open, or with another row open */
+    unsigned long long int rowHits;
+    unsigned long long int rowMisses;
+    unsigned long long int rowConflicts;
+    /* The bandwidth intervals completed, and the most bytes moved in one of them; the
+     * trailing partial interval is in neither */
+    unsigned long long int intervals;
+    unsigned long long int peakIntervalBytes;
+};
+
+typedef struct cacheSimStats CacheSimStats;
+struct cacheSimStats
+{
+    CacheSimCounters noPrefetch;
+    CacheSimCounters withPrefetch;
+    /* Zero unless the configuration has TLBs. Page walk reads are not counted in
+     * noPrefetch and withPrefetch, but do change what the caches hold */
+    CacheSimTlbCounters tlb;
+    /* Zero unless the configuration has DRAM. Unlike memoryReads, these count the
+     * reads of page walks too */
+    CacheSimDramCounters noPrefetchDram;
+    CacheSimDramCounters withPrefetchDram;
+};
+
+typedef struct cacheSim CacheSim;
+
+/* Phase timers for profiling the simulator itself; see profile.h */
+typedef struct cacheSimProfile CacheSimProfile;
+
+/* Return 0 if config is valid; otherwise write a message into error and return -1 */
+int cacheSimCheckConfig(const CacheSimConfig *config, char *error, size_t errorLength);
+
+/* Create a hierarchy with empty caches; returns NULL if config is invalid */
+CacheSim *cacheSimCreate(const CacheSimConfig *config);
+
+/* Simulate one access; returns CACHESIM_L1_HIT, CACHESIM_L2_HIT or CACHESIM_MEMORY.
+ * A block found in a level's victim or miss cache counts as a hit at that level */
+int cacheSimAccess(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation);
+
+/* Count repeats more accesses, writes of them writes, to the block of the last access
+ * without simulating them. Each one hits L1 in both hierarchies and changes no cache,
+ * since the block is already the most recently used, so the counters come out as if
+ * every access had been simulated. Not for hierarchies with TLBs, which look up every
+ * access's page and PC, or with DRAM, which sees every write */
+void cacheSimRepeatAccess(CacheSim *sim, unsigned long long int repeats, unsigned long long int writes);
+
+/* Simulate n accesses in order */
+void cacheSimAccessMany(CacheSim *sim, const CacheSimAccess *accesses, size_t n);
+
+/* Simulate one access in L1 only; returns CACHESIM_L1_HIT, or CACHESIM_MEMORY on a miss.
+ * cacheSimAccessL1 and cacheSimAccessL2 do not model the TLBs or DRAM.
+ * Used to filter a trace down to its L1 misses once for many L2 configurations */
+int cacheSimAccessL1(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation);
+
+/* Simulate one access that is known to miss in L1, starting at L2. Returns -1 without
+ * simulating it if the hierarchy has DRAM, whose bandwidth intervals are counted in
+ * accesses, not in L1 misses */
+int cacheSimAccessL2(CacheSim *sim, unsigned long long int address, unsigned long long int pc, char operation);
+
+void cacheSimGetStats(const CacheSim *sim, CacheSimStats *stats);
+
+/* Charge the time of each later access to the profile's TLB, decode, L1 and L2 phases;
+ * NULL (the default) turns the timers off. The caller marks the phases around the calls */
+void cacheSimSetProfile(CacheSim *sim, CacheSimProfile *profile);
+
+/* Empty every cache and zero the counters, keeping the configuration */
+void cacheSimReset(CacheSim *sim);
+
+void cacheSimDestroy(CacheSim *sim);
+
+#endif
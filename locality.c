@@ -0,0 +1,424 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  locality.c
+ *
+ *    Description:  Streaming locality analysis: reuse-distance histograms and
+ *                  working-set-size curves computed from the access stream.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "locality.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int log2Floor(unsigned long long int n);
+static unsigned long int mixHash(unsigned long long int key);
+static unsigned long int tableSizeFor(unsigned long int n);
+static int reuseBucket(unsigned long long int distance);
+static void addMark(ReuseTracker *tracker, unsigned int stamp, int delta);
+static int countMarks(ReuseTracker *tracker, unsigned int stamp);
+static unsigned long int findReuseEntry(ReuseTracker *tracker, unsigned long long int block);
+static void compactReuseTracker(ReuseTracker *tracker);
+static int compareStampsDescending(const void *a, const void *b);
+static int insertWorkingSetKey(unsigned long long int *keys, unsigned int *generations, unsigned long int mask, unsigned int generation, unsigned long long int key);
+static void endWorkingSetInterval(WorkingSetTracker *tracker);
+
+
+ReuseTracker *createReuseTracker(int blockSize, unsigned int window)
+{
+    /* Memory use is bounded by the window: a table of 2 * window entries and a
+     * Fenwick tree of window counters; nothing grows with the length of the trace */
+    if (window < 2)
+    {
+        window = 2;
+    }
+    if (window > REUSE_MAX_WINDOW)
+    {
+        return 0;
+    }
+
+    ReuseTracker *tracker = (ReuseTracker *) calloc(1, sizeof(ReuseTracker));
+    if (tracker == 0)
+    {
+        return 0;
+    }
+    unsigned long int tableSize = tableSizeFor(2UL * window);
+
+    tracker -> blockOffsetBits = log2Floor(blockSize);
+    tracker -> window = window;
+    tracker -> entries = (ReuseEntry *) calloc(tableSize, sizeof(ReuseEntry));
+    tracker -> tableMask = tableSize - 1;
+    tracker -> marks = (int *) calloc(window + 1, sizeof(int));
+    if (tracker -> entries == 0 || tracker -> marks == 0)
+    {
+        freeReuseTracker(tracker);
+        return 0;
+    }
+
+    return tracker;
+}
+
+
+void recordReuse(ReuseTracker *tracker, unsigned long long int address)
+{
+    /* Make room for a new stamp before looking anything up, so the entry found
+     * below is still valid when it is updated */
+    if (tracker -> now == tracker -> window)
+    {
+        compactReuseTracker(tracker);
+    }
+
+    unsigned long long int block = address >> tracker -> blockOffsetBits;
+    unsigned long int slot = findReuseEntry(tracker, block);
+    ReuseEntry *entry = &tracker -> entries[slot];
+
+    tracker -> accesses++;
+
+    /* If the block is remembered, record how long ago it was last used */
+    if (entry -> stamp)
+    {
+        unsigned long long int accessDistance = tracker -> accesses - entry -> lastAccess - 1;
+        /* Every marked stamp after this block's stamp is a distinct block used since */
+        unsigned long long int blockDistance = countMarks(tracker, tracker -> now) - countMarks(tracker, entry -> stamp);
+
+        tracker -> byAccesses[reuseBucket(accessDistance)]++;
+        tracker -> byBlocks[reuseBucket(blockDistance)]++;
+
+        addMark(tracker, entry -> stamp, -1);
+    }
+    /* Otherwise, this is a first touch, or the block fell out of the window */
+    else
+    {
+        tracker -> untracked++;
+    }
+
+    tracker -> now++;
+    addMark(tracker, tracker -> now, 1);
+    entry -> block = block;
+    entry -> stamp = tracker -> now;
+    entry -> lastAccess = tracker -> accesses;
+}
+
+
+void printReuseHistogram(ReuseTracker *tracker, const char *label)
+{
+    int i, last = -1;
+    for (i = 0; i < REUSE_BUCKETS; i++)
+    {
+        if (tracker -> byAccesses[i] || tracker -> byBlocks[i])
+        {
+            last = i;
+        }
+    }
+
+    printf("-----\n%s Reuse Distance (%d-byte blocks)\n-----\n", label, 1 << tracker -> blockOffsetBits);
+    printf("%-24s %-16s %s\n", "Distance", "By accesses", "By unique blocks");
+    for (i = 0; i <= last; i++)
+    {
+        char range[48];
+        if (i == 0)
+        {
+            snprintf(range, sizeof(range), "0");
+        }
+        else if (i == 1)
+        {
+            snprintf(range, sizeof(range), "1");
+        }
+        else
+        {
+            snprintf(range, sizeof(range), "%llu-%llu", 1ULL << (i - 1), (1ULL << i) - 1);
+        }
+        printf("%-24s %-16llu %llu\n", range, tracker -> byAccesses[i], tracker -> byBlocks[i]);
+    }
+    printf("Untracked (first touch or beyond %u blocks): %llu\n", tracker -> window / 2, tracker -> untracked);
+}
+
+
+void freeReuseTracker(ReuseTracker *tracker)
+{
+    free(tracker -> entries);
+    free(tracker -> marks);
+    free(tracker);
+}
+
+
+WorkingSetTracker *createWorkingSetTracker(int blockSize, unsigned long int interval, FILE *out)
+{
+    /* An interval touches at most interval distinct blocks and pages, so sets of
+     * twice that size never fill up */
+    if (interval < 1)
+    {
+        interval = 1;
+    }
+
+    WorkingSetTracker *tracker = (WorkingSetTracker *) calloc(1, sizeof(WorkingSetTracker));
+    if (tracker == 0)
+    {
+        return 0;
+    }
+    unsigned long int tableSize = tableSizeFor(2 * interval);
+
+    tracker -> blockOffsetBits = log2Floor(blockSize);
+    tracker -> pageOffsetBits = log2Floor(WSS_PAGE_SIZE);
+    tracker -> interval = interval;
+    tracker -> blockKeys = (unsigned long long int *) malloc(tableSize * sizeof(unsigned long long int));
+    tracker -> pageKeys = (unsigned long long int *) malloc(tableSize * sizeof(unsigned long long int));
+    tracker -> blockGenerations = (unsigned int *) calloc(tableSize, sizeof(unsigned int));
+    tracker -> pageGenerations = (unsigned int *) calloc(tableSize, sizeof(unsigned int));
+    if (!tracker -> blockKeys || !tracker -> pageKeys || !tracker -> blockGenerations || !tracker -> pageGenerations)
+    {
+        freeWorkingSetTracker(tracker);
+        return 0;
+    }
+    tracker -> tableMask = tableSize - 1;
+    tracker -> generation = 1;
+    tracker -> out = out;
+
+    if (out)
+    {
+        fprintf(out, "# accesses blocks pages (%d-byte blocks, %d-byte pages, %lu accesses per interval)\n",
+                blockSize, WSS_PAGE_SIZE, interval);
+    }
+
+    return tracker;
+}
+
+
+void recordWorkingSet(WorkingSetTracker *tracker, unsigned long long int address)
+{
+    tracker -> blocks += insertWorkingSetKey(tracker -> blockKeys, tracker -> blockGenerations, tracker -> tableMask,
+                                             tracker -> generation, address >> tracker -> blockOffsetBits);
+    tracker -> pages += insertWorkingSetKey(tracker -> pageKeys, tracker -> pageGenerations, tracker -> tableMask,
+                                            tracker -> generation, address >> tracker -> pageOffsetBits);
+    tracker -> accesses++;
+    tracker -> intervalAccesses++;
+
+    if (tracker -> intervalAccesses == tracker -> interval)
+    {
+        endWorkingSetInterval(tracker);
+    }
+}
+
+
+void printWorkingSetSummary(WorkingSetTracker *tracker)
+{
+    /* Emit the trailing partial interval so the curve covers the whole trace */
+    if (tracker -> out && tracker -> intervalAccesses)
+    {
+        fprintf(tracker -> out, "%llu %lu %lu\n", tracker -> accesses, tracker -> blocks, tracker -> pages);
+    }
+
+    printf("-----\nWorking Set (%lu accesses per interval)\n-----\n", tracker -> interval);
+    printf("Intervals: %lu\n", tracker -> intervals);
+    if (tracker -> intervals)
+    {
+        printf("Mean working set: %.1f blocks, %.1f pages\n",
+               (double) tracker -> totalBlocks / tracker -> intervals,
+               (double) tracker -> totalPages / tracker -> intervals);
+        printf("Peak working set: %lu blocks, %lu pages\n", tracker -> maxBlocks, tracker -> maxPages);
+    }
+    else
+    {
+        printf("Working set: %lu blocks, %lu pages\n", tracker -> blocks, tracker -> pages);
+    }
+}
+
+
+void freeWorkingSetTracker(WorkingSetTracker *tracker)
+{
+    free(tracker -> blockKeys);
+    free(tracker -> pageKeys);
+    free(tracker -> blockGenerations);
+    free(tracker -> pageGenerations);
+    free(tracker);
+}
+
+
+static int log2Floor(unsigned long long int n)
+{
+    int log = 0;
+    while (n > 1)
+    {
+        n = n >> 1;
+        log++;
+    }
+
+    return log;
+}
+
+
+static unsigned long int mixHash(unsigned long long int key)
+{
+    /* Finalizer from MurmurHash3; spreads strided block addresses across the table */
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+
+    return (unsigned long int) key;
+}
+
+
+static unsigned long int tableSizeFor(unsigned long int n)
+{
+    unsigned long int size = 1;
+    while (size < n)
+    {
+        size = size << 1;
+    }
+
+    return size;
+}
+
+
+static int reuseBucket(unsigned long long int distance)
+{
+    if (distance == 0)
+    {
+        return 0;
+    }
+
+    return log2Floor(distance) + 1;
+}
+
+
+static void addMark(ReuseTracker *tracker, unsigned int stamp, int delta)
+{
+    for (; stamp <= tracker -> window; stamp += stamp & -stamp)
+    {
+        tracker -> marks[stamp] += delta;
+    }
+}
+
+
+static int countMarks(ReuseTracker *tracker, unsigned int stamp)
+{
+    /* Number of marked stamps in [1, stamp] */
+    int count = 0;
+    for (; stamp > 0; stamp -= stamp & -stamp)
+    {
+        count += tracker -> marks[stamp];
+    }
+
+    return count;
+}
+
+
+static unsigned long int findReuseEntry(ReuseTracker *tracker, unsigned long long int block)
+{
+    /* Return the slot holding block, or the empty slot where it belongs */
+    unsigned long int slot = mixHash(block) & tracker -> tableMask;
+    while (tracker -> entries[slot].stamp && tracker -> entries[slot].block != block)
+    {
+        slot = (slot + 1) & tracker -> tableMask;
+    }
+
+    return slot;
+}
+
+
+static void compactReuseTracker(ReuseTracker *tracker)
+{
+    /* Keep the most recent half of the window, renumbered 1..k in the same order,
+     * so the stamps restart from k without changing any distance still measurable */
+    unsigned long int tableSize = tracker -> tableMask + 1;
+    unsigned long int i, live = 0;
+    ReuseEntry *kept = (ReuseEntry *) malloc(tracker -> window * sizeof(ReuseEntry));
+
+    for (i = 0; i < tableSize; i++)
+    {
+        if (tracker -> entries[i].stamp)
+        {
+            kept[live++] = tracker -> entries[i];
+        }
+    }
+    qsort(kept, live, sizeof(ReuseEntry), compareStampsDescending);
+    if (live > tracker -> window / 2)
+    {
+        live = tracker -> window / 2;
+    }
+
+    memset(tracker -> entries, 0, tableSize * sizeof(ReuseEntry));
+    memset(tracker -> marks, 0, (tracker -> window + 1) * sizeof(int));
+    for (i = 0; i < live; i++)
+    {
+        ReuseEntry entry = kept[i];
+        entry.stamp = live - i;
+        tracker -> entries[findReuseEntry(tracker, entry.block)] = entry;
+        addMark(tracker, entry.stamp, 1);
+    }
+    tracker -> now = live;
+
+    free(kept);
+}
+
+
+static int compareStampsDescending(const void *a, const void *b)
+{
+    unsigned int stampA = ((const ReuseEntry *) a) -> stamp;
+    unsigned int stampB = ((const ReuseEntry *) b) -> stamp;
+
+    return (stampA < stampB) - (stampA > stampB);
+}
+
+
+static int insertWorkingSetKey(unsigned long long int *keys, unsigned int *generations, unsigned long int mask, unsigned int generation, unsigned long long int key)
+{
+    /* Return 1 if key is new in this interval; slots from older intervals count as empty */
+    unsigned long int slot = mixHash(key) & mask;
+    while (generations[slot] == generation)
+    {
+        if (keys[slot] == key)
+        {
+            return 0;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    keys[slot] = key;
+    generations[slot] = generation;
+
+    return 1;
+}
+
+
+static void endWorkingSetInterval(WorkingSetTracker *tracker)
+{
+    if (tracker -> out)
+    {
+        fprintf(tracker -> out, "%llu %lu %lu\n", tracker -> accesses, tracker -> blocks, tracker -> pages);
+    }
+
+    tracker -> intervals++;
+    tracker -> totalBlocks += tracker -> blocks;
+    tracker -> totalPages += tracker -> pages;
+    if (tracker -> blocks > tracker -> maxBlocks)
+    {
+        tracker -> maxBlocks = tracker -> blocks;
+    }
+    if (tracker -> pages > tracker -> maxPages)
+    {
+        tracker -> maxPages = tracker -> pages;
+    }
+
+    tracker -> blocks = 0;
+    tracker -> pages = 0;
+    tracker -> intervalAccesses = 0;
+
+    /* Start a fresh generation; on wrap-around, clear the tables explicitly */
+    tracker -> generation++;
+    if (tracker -> generation == 0)
+    {
+        memset(tracker -> blockGenerations, 0, (tracker -> tableMask + 1) * sizeof(unsigned int));
+        memset(tracker -> pageGenerations, 0, (tracker -> tableMask + 1) * sizeof(unsigned int));
+        tracker -> generation = 1;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  locality.h
+ *
+ *    Description:  Streaming locality analysis: reuse-distance histograms and
+ *                  working-set-size curves computed from the access stream.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef LOCALITY_H
+#define LOCALITY_H
+
+#include <stdio.h>
+
+/* Number of log2 buckets in a reuse-distance histogram; bucket 0 holds distance 0,
+ * bucket k holds distances in [2^(k-1), 2^k) */
+#define REUSE_BUCKETS 64
+
+/* Default number of distinct blocks a ReuseTracker remembers */
+#define REUSE_DEFAULT_WINDOW (1 << 18)
+
+/* The largest window createReuseTracker takes (twice the blocks remembered); its table
+ * alone is then 32M entries */
+#define REUSE_MAX_WINDOW (1 << 24)
+
+/* Default number of accesses per working-set interval */
+#define WSS_DEFAULT_INTERVAL 10000
+
+/* Page size used for the page-granularity working set */
+#define WSS_PAGE_SIZE 4096
+
+typedef struct reuseEntry ReuseEntry;
+struct reuseEntry
+{
+    unsigned long long int block;
+    unsigned long long int lastAccess;
+    unsigned int stamp;
+};
+
+typedef struct reuseTracker ReuseTracker;
+struct reuseTracker
+{
+    int blockOffsetBits;
+    /* The maximum number of distinct blocks remembered at once */
+    unsigned int window;
+    /* Open-addressed table of the remembered blocks, keyed by block address */
+    ReuseEntry *entries;
+    unsigned long int tableMask;
+    /* Fenwick tree over stamps; a 1 at stamp s means some block was last seen at s */
+    int *marks;
+    unsigned int now;
+    unsigned long long int accesses;
+    /* Histograms by intervening accesses and by intervening unique blocks */
+    unsigned long long int byAccesses[REUSE_BUCKETS];
+    unsigned long long int byBlocks[REUSE_BUCKETS];
+    /* First touches, and reuses of blocks that have fallen out of the window */
+    unsigned long long int untracked;
+};
+
+typedef struct workingSetTracker WorkingSetTracker;
+struct workingSetTracker
+{
+    int blockOffsetBits;
+    int pageOffsetBits;
+    unsigned long int interval;
+    /* Generation-tagged sets of the blocks and pages touched in the current interval */
+    unsigned long long int *blockKeys;
+    unsigned long long int *pageKeys;
+    unsigned int *blockGenerations;
+    unsigned int *pageGenerations;
+    unsigned long int tableMask;
+    unsigned int generation;
+    unsigned long int intervalAccesses;
+    unsigned long int blocks;
+    unsigned long int pages;
+    unsigned long long int accesses;
+    /* Summary of the curve so far */
+    unsigned long int intervals;
+    unsigned long int maxBlocks;
+    unsigned long int maxPages;
+    unsigned long long int totalBlocks;
+    unsigned long long int totalPages;
+    /* The curve is streamed here one interval at a time */
+    FILE *out;
+};
+
+/* The create functions return NULL if the memory cannot be allocated, or for a ReuseTracker,
+ * if window is above REUSE_MAX_WINDOW */
+ReuseTracker *createReuseTracker(int blockSize, unsigned int window);
+void recordReuse(ReuseTracker *tracker, unsigned long long int address);
+void printReuseHistogram(ReuseTracker *tracker, const char *label);
+void freeReuseTracker(ReuseTracker *tracker);
+
+WorkingSetTracker *createWorkingSetTracker(int blockSize, unsigned long int interval, FILE *out);
+void recordWorkingSet(WorkingSetTracker *tracker, unsigned long long int address);
+void printWorkingSetSummary(WorkingSetTracker *tracker);
+void freeWorkingSetTracker(WorkingSetTracker *tracker);
+
+#endif
@@ -0,0 +1,395 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  memo.c
+ *
+ *    Description:  On-disk memoization of simulation results
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "memo.h"
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The memo directory holds one file per result, and a remembered digest per trace */
+#define MEMO_RESULTS "results"
+#define MEMO_DIGESTS "digests"
+
+#define MEMO_READ_SIZE (1 << 16)
+
+/* 128-bit digest state: two 64-bit lanes, mixed a word at a time (after MurmurHash3) */
+typedef struct digest Digest;
+struct digest
+{
+    unsigned long long int h1;
+    unsigned long long int h2;
+    unsigned long long int length;
+};
+
+/* The counters stored in a memo file, by name */
+typedef struct memoField MemoField;
+struct memoField
+{
+    const char *name;
+    size_t offset;
+};
+
+#define COUNTER_FIELDS(counters) \
+    { #counters ".totalInstructions", offsetof(CacheSimStats, counters.totalInstructions) }, \
+    { #counters ".memoryReads", offsetof(CacheSimStats, counters.memoryReads) }, \
+    { #counters ".memoryWrites", offsetof(CacheSimStats, counters.memoryWrites) }, \
+    { #counters ".l1CacheHits", offsetof(CacheSimStats, counters.l1CacheHits) }, \
+    { #counters ".l1CacheMisses", offsetof(CacheSimStats, counters.l1CacheMisses) }, \
+    { #counters ".l2CacheHits", offsetof(CacheSimStats, counters.l2CacheHits) }, \
+    { #counters ".l2CacheMisses", offsetof(CacheSimStats, counters.l2CacheMisses) }, \
+    { #counters ".l1VictimHits", offsetof(CacheSimStats, counters.l1VictimHits) }, \
+    { #counters ".l2VictimHits", offsetof(CacheSimStats, counters.l2VictimHits) }, \
+    { #counters ".l1SectorMisses", offsetof(CacheSimStats, counters.l1SectorMisses) }, \
+    { #counters ".l2SectorMisses", offsetof(CacheSimStats, counters.l2SectorMisses) }, \
+    { #counters ".overallMisses", offsetof(CacheSimStats, counters.overallMisses) }
+
+#define TLB_FIELD(field) { "tlb." #field, offsetof(CacheSimStats, tlb.field) }
+
+#define DRAM_FIELDS(counters) \
+    { #counters ".reads", offsetof(CacheSimStats, counters.reads) }, \
+    { #counters ".writes", offsetof(CacheSimStats, counters.writes) }, \
+    { #counters ".bytesRead", offsetof(CacheSimStats, counters.bytesRead) }, \
+    { #counters ".bytesWritten", offsetof(CacheSimStats, counters.bytesWritten) }, \
+    { #counters ".rowHits", offsetof(CacheSimStats, counters.rowHits) }, \
+    { #counters ".rowMisses", offsetof(CacheSimStats, counters.rowMisses) }, \
+    { #counters ".rowConflicts", offsetof(CacheSimStats, counters.rowConflicts) }, \
+    { #counters ".intervals", offsetof(CacheSimStats, counters.intervals) }, \
+    { #counters ".peakIntervalBytes", offsetof(CacheSimStats, counters.peakIntervalBytes) }
+
+static const MemoField memoFields[] =
+{
+    COUNTER_FIELDS(noPrefetch),
+    COUNTER_FIELDS(withPrefetch),
+    TLB_FIELD(dtlbHits), TLB_FIELD(dtlbMisses), TLB_FIELD(itlbHits), TLB_FIELD(itlbMisses),
+    TLB_FIELD(l2TlbHits), TLB_FIELD(l2TlbMisses), TLB_FIELD(pageWalks), TLB_FIELD(walkAccesses),
+    TLB_FIELD(walkL1Hits), TLB_FIELD(walkL2Hits), TLB_FIELD(walkMemoryReads),
+    DRAM_FIELDS(noPrefetchDram),
+    DRAM_FIELDS(withPrefetchDram)
+};
+
+#define NUM_MEMO_FIELDS (sizeof(memoFields) / sizeof(memoFields[0]))
+
+static void startDigest(Digest *digest);
+static void updateDigest(Digest *digest, const unsigned char *data, size_t length);
+static void finishDigest(Digest *digest, char *hex);
+static unsigned long long int mix(unsigned long long int k);
+static int makeDirectory(const char *path);
+static void memoPath(char *path, size_t pathLength, const char *dir, const char *subdir, const char *key);
+static int writeAtomically(const char *path, const char *contents);
+
+
+int openMemo(const char *dir)
+{
+    char path[PATH_MAX];
+    if (makeDirectory(dir))
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, MEMO_RESULTS);
+    if (makeDirectory(path))
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, MEMO_DIGESTS);
+    return makeDirectory(path);
+}
+
+
+int digestTrace(const char *dir, const char *path, char *hex)
+{
+    /* The remembered digest, if the file has not changed since it was taken */
+    char fullPath[PATH_MAX], identity[PATH_MAX + 128], identityHex[MEMO_DIGEST_LENGTH], digestPath[PATH_MAX];
+    struct stat status;
+    if (realpath(path, fullPath) == 0 || stat(fullPath, &status))
+    {
+        return -1;
+    }
+    snprintf(identity, sizeof(identity), "%s %llu %llu %llu %lld.%09ld", fullPath, (unsigned long long int) status.st_dev,
+             (unsigned long long int) status.st_ino, (unsigned long long int) status.st_size,
+             (long long int) status.st_mtim.tv_sec, status.st_mtim.tv_nsec);
+    digestBytes(identity, strlen(identity), identityHex);
+    memoPath(digestPath, sizeof(digestPath), dir, MEMO_DIGESTS, identityHex);
+
+    FILE *fp = fopen(digestPath, "r");
+    if (fp)
+    {
+        int found = (fscanf(fp, "%32s", hex) == 1 && strlen(hex) == MEMO_DIGEST_LENGTH - 1);
+        fclose(fp);
+        if (found)
+        {
+            return 0;
+        }
+    }
+
+    /* Otherwise read the whole trace */
+    fp = fopen(fullPath, "rb");
+    if (fp == 0)
+    {
+        return -1;
+    }
+    unsigned char *buffer = (unsigned char *) malloc(MEMO_READ_SIZE);
+    Digest digest;
+    startDigest(&digest);
+    size_t n;
+    while ((n = fread(buffer, 1, MEMO_READ_SIZE, fp)) > 0)
+    {
+        updateDigest(&digest, buffer, n);
+    }
+    int failed = ferror(fp);
+    fclose(fp);
+    free(buffer);
+    if (failed)
+    {
+        return -1;
+    }
+    finishDigest(&digest, hex);
+
+    /* Remembering it is only an optimization, so a failure here is not an error */
+    char contents[MEMO_DIGEST_LENGTH + 1];
+    snprintf(contents, sizeof(contents), "%s\n", hex);
+    writeAtomically(digestPath, contents);
+
+    return 0;
+}
+
+
+void digestBytes(const void *data, size_t length, char *hex)
+{
+    Digest digest;
+    startDigest(&digest);
+    updateDigest(&digest, (const unsigned char *) data, length);
+    finishDigest(&digest, hex);
+}
+
+
+void makeMemoKey(char *key, size_t keyLength, const char *traceDigest, const CacheSimConfig *config,
+                 int traceFormat, unsigned long long int skipRecords, unsigned long long int limitRecords)
+{
+    /* Fully associative levels are written as their number of ways, so assoc and
+     * assoc:n with n ways give the same key, and unsectored levels as one sector */
+    const CacheSimLevelConfig *l1 = &config -> l1, *l2 = &config -> l2;
+    int l1Ways = l1 -> associativity ? l1 -> associativity : l1 -> size / l1 -> blockSize;
+    int l2Ways = l2 -> associativity ? l2 -> associativity : l2 -> size / l2 -> blockSize;
+    int length = snprintf(key, keyLength,
+                          "v%d trace=%s format=%d skip=%llu limit=%llu "
+                          "l1=%d,%d,%d,%d,%d,%d,%d l2=%d,%d,%d,%d,%d,%d,%d",
+                          MEMO_VERSION, traceDigest, traceFormat, skipRecords, limitRecords,
+                          l1 -> size, l1Ways, l1 -> blockSize, l1 -> indexFunction,
+                          l1 -> victimEntries, l1 -> victimEntries ? l1 -> missCache != 0 : 0, l1 -> sectors > 1 ? l1 -> sectors : 1,
+                          l2 -> size, l2Ways, l2 -> blockSize, l2 -> indexFunction,
+                          l2 -> victimEntries, l2 -> victimEntries ? l2 -> missCache != 0 : 0, l2 -> sectors > 1 ? l2 -> sectors : 1);
+
+    if (config -> dtlb.entries && length > 0 && length < keyLength)
+    {
+        const CacheSimTlbConfig *tlbs[] = { &config -> dtlb, &config -> itlb, &config -> l2Tlb };
+        int i;
+        for (i = 0; i < 3 && length < keyLength; i++)
+        {
+            int ways = tlbs[i] -> associativity ? tlbs[i] -> associativity : tlbs[i] -> entries;
+            length += snprintf(key + length, keyLength - length, "%s%d:%d", i ? "," : " tlb=", tlbs[i] -> entries, ways);
+        }
+        if (length < keyLength)
+        {
+            length += snprintf(key + length, keyLength - length, " page=%d walks=%d", config -> pageSize, config -> pageWalks != 0);
+        }
+    }
+
+    if (config -> dram.channels && length > 0 && length < keyLength)
+    {
+        const CacheSimDramConfig *dram = &config -> dram;
+        snprintf(key + length, keyLength - length, " dram=%d:%d:%d:%d interval=%lu",
+                 dram -> channels, dram -> banks, dram -> rowSize, dram -> burstSize, dram -> interval);
+    }
+}
+
+
+int loadMemo(const char *dir, const char *key, CacheSimStats *stats)
+{
+    char keyHex[MEMO_DIGEST_LENGTH], path[PATH_MAX];
+    digestBytes(key, strlen(key), keyHex);
+    memoPath(path, sizeof(path), dir, MEMO_RESULTS, keyHex);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == 0)
+    {
+        return 0;
+    }
+
+    /* The first line is the key itself, in case two keys share a digest */
+    size_t keyLength = strlen(key);
+    char *line = (char *) malloc(keyLength + 2);
+    int found = (fgets(line, keyLength + 2, fp) && !strncmp(line, key, keyLength) && line[keyLength] == '\n');
+    free(line);
+
+    /* Then one "name value" line per counter; every counter must be there */
+    CacheSimStats loaded;
+    memset(&loaded, 0, sizeof(CacheSimStats));
+    char name[64];
+    unsigned long long int value;
+    size_t numFound = 0, i;
+    while (found && fscanf(fp, "%63s %llu", name, &value) == 2)
+    {
+        for (i = 0; i < NUM_MEMO_FIELDS; i++)
+        {
+            if (!strcmp(name, memoFields[i].name))
+            {
+                *(unsigned long long int *) ((char *) &loaded + memoFields[i].offset) = value;
+                numFound++;
+                break;
+            }
+        }
+    }
+    fclose(fp);
+
+    if (!found || numFound != NUM_MEMO_FIELDS)
+    {
+        return 0;
+    }
+    *stats = loaded;
+    return 1;
+}
+
+
+int storeMemo(const char *dir, const char *key, const CacheSimStats *stats)
+{
+    char keyHex[MEMO_DIGEST_LENGTH], path[PATH_MAX];
+    digestBytes(key, strlen(key), keyHex);
+    memoPath(path, sizeof(path), dir, MEMO_RESULTS, keyHex);
+
+    size_t capacity = strlen(key) + 2 + MEMO_STATS_LENGTH;
+    char *contents = (char *) malloc(capacity);
+    size_t length = snprintf(contents, capacity, "%s\n", key);
+    formatStats(contents + length, capacity - length, stats);
+
+    int status = writeAtomically(path, contents);
+    free(contents);
+    return status;
+}
+
+
+int formatStats(char *buffer, size_t length, const CacheSimStats *stats)
+{
+    int written = 0;
+    size_t i;
+    buffer[0] = '\0';
+    for (i = 0; i < NUM_MEMO_FIELDS && written < length; i++)
+    {
+        written += snprintf(buffer + written, length - written, "%s %llu\n", memoFields[i].name,
+                            *(const unsigned long long int *) ((const char *) stats + memoFields[i].offset));
+    }
+    return written;
+}
+
+
+static void startDigest(Digest *digest)
+{
+    digest -> h1 = 0x9368e53c2f6af274ULL;
+    digest -> h2 = 0x586dcd208f7cd3fdULL;
+    digest -> length = 0;
+}
+
+
+static void updateDigest(Digest *digest, const unsigned char *data, size_t length)
+{
+    /* Whole 8-byte words are mixed into both lanes. Reads are a multiple of 8 bytes
+     * except for the last, so a partial word is only ever at the end; it is padded with zeros */
+    size_t i;
+    for (i = 0; i < length; i += 8)
+    {
+        unsigned long long int k = 0;
+        size_t n = (length - i < 8) ? length - i : 8;
+        memcpy(&k, data + i, n);
+
+        digest -> h1 ^= mix(k);
+        digest -> h1 = ((digest -> h1 << 27) | (digest -> h1 >> 37)) + digest -> h2;
+        digest -> h1 = digest -> h1 * 5 + 0x52dce729;
+
+        digest -> h2 ^= mix(k ^ 0x38495ab5ULL);
+        digest -> h2 = ((digest -> h2 << 31) | (digest -> h2 >> 33)) + digest -> h1;
+        digest -> h2 = digest -> h2 * 5 + 0x38495ab5;
+    }
+    digest -> length += length;
+}
+
+
+static void finishDigest(Digest *digest, char *hex)
+{
+    digest -> h1 ^= digest -> length;
+    digest -> h2 ^= digest -> length;
+    digest -> h1 += digest -> h2;
+    digest -> h2 += digest -> h1;
+    digest -> h1 = mix(digest -> h1);
+    digest -> h2 = mix(digest -> h2);
+    digest -> h1 += digest -> h2;
+    digest -> h2 += digest -> h1;
+    snprintf(hex, MEMO_DIGEST_LENGTH, "%016llx%016llx", digest -> h1, digest -> h2);
+}
+
+
+static unsigned long long int mix(unsigned long long int k)
+{
+    /* The 64-bit finalizer of MurmurHash3 */
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+
+static int makeDirectory(const char *path)
+{
+    /* Returns 0 if path is (now) a directory */
+    struct stat status;
+    if (mkdir(path, 0777) && errno != EEXIST)
+    {
+        return -1;
+    }
+    return (stat(path, &status) == 0 && S_ISDIR(status.st_mode)) ? 0 : -1;
+}
+
+
+static void memoPath(char *path, size_t pathLength, const char *dir, const char *subdir, const char *key)
+{
+    snprintf(path, pathLength, "%s/%s/%s", dir, subdir, key);
+}
+
+
+static int writeAtomically(const char *path, const char *contents)
+{
+    /* Write to a temporary file and rename it into place, so concurrent runs of a
+     * sweep never see a partial file; returns 0 on success, -1 on error */
+    char temporary[PATH_MAX];
+    snprintf(temporary, sizeof(temporary), "%s.%ld.tmp", path, (long int) getpid());
+
+    FILE *fp = fopen(temporary, "w");
+    if (fp == 0)
+    {
+        return -1;
+    }
+    int failed = (fputs(contents, fp) == EOF);
+    failed |= (fclose(fp) != 0);
+    if (failed || rename(temporary, path))
+    {
+        unlink(temporary);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  memo.h
+ *
+ *    Description:  On-disk memoization of simulation results. A result is stored
+ *                  under a digest of the trace's content and a normalized form of
+ *                  the configuration, so a sweep that revisits a point reads its
+ *                  counters back instead of simulating it again.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "libcachesim.h"
+#include <stddef.h>
+
+/* Part of every key; bump it when a change to the engine changes results */
+#define MEMO_VERSION 3
+
+/* A digest is 128 bits, written as 32 hex digits */
+#define MEMO_DIGEST_LENGTH 33
+
+/* Create the memo directory and its subdirectories if need be; returns 0 on success, -1 on error */
+int openMemo(const char *dir);
+
+/* Digest the content of the file at path into hex. The digest is remembered in dir
+ * by the file's path, size and modification time, so an unchanged trace is only
+ * read once. Returns 0 on success, -1 if the file cannot be read */
+int digestTrace(const char *dir, const char *path, char *hex);
+
+/* Digest length bytes of data into hex */
+void digestBytes(const void *data, size_t length, char *hex);
+
+/* Write the key of a simulation: the trace digest, and every setting that can change
+ * the counters, in a fixed form. Settings that cannot, such as huge pages, are left out */
+void makeMemoKey(char *key, size_t keyLength, const char *traceDigest, const CacheSimConfig *config,
+                 int traceFormat, unsigned long long int skipRecords, unsigned long long int limitRecords);
+
+/* Read the counters stored under key; returns 1 if they were found, 0 otherwise */
+int loadMemo(const char *dir, const char *key, CacheSimStats *stats);
+
+/* Store the counters under key; returns 0 on success, -1 on error */
+int storeMemo(const char *dir, const char *key, const CacheSimStats *stats);
+
+/* Write every counter as a "name value" line, for example "noPrefetch.l1CacheHits 42",
+ * into buffer; returns the length written, as snprintf */
+int formatStats(char *buffer, size_t length, const CacheSimStats *stats);
+
+/* The buffer size formatStats needs */
+#define MEMO_STATS_LENGTH 4096
+
+#endif
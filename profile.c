@@ -0,0 +1,190 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  profile.c
+ *
+ *    Description:  Phase timers and hardware counters for profiling the simulator
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "profile.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+static const char *phaseNames[PROFILE_PHASES] =
+{
+    "Trace parsing", "TLB", "Address decode", "L1 lookup", "L2 lookup", "Other", "Output"
+};
+
+static const char *perfNames[PROFILE_PERF_COUNTERS] =
+{
+    "CPU cycles", "LLC misses", "Branch misses"
+};
+
+static double wallSeconds(void);
+static int openPerfCounter(int counter);
+
+
+CacheSimProfile *createProfile(int perfCounters)
+{
+    CacheSimProfile *profile = (CacheSimProfile *) calloc(1, sizeof(CacheSimProfile));
+    if (profile == 0)
+    {
+        return 0;
+    }
+    int i;
+    for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+    {
+        profile -> perfFds[i] = -1;
+    }
+    if (perfCounters)
+    {
+        for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+        {
+            profile -> perfFds[i] = openPerfCounter(i);
+            if (profile -> perfFds[i] < 0 && !profile -> perfError)
+            {
+                profile -> perfError = errno;
+            }
+        }
+    }
+    return profile;
+}
+
+
+void startProfile(CacheSimProfile *profile)
+{
+    memset(profile -> ticks, 0, sizeof(profile -> ticks));
+    memset(profile -> marks, 0, sizeof(profile -> marks));
+#ifdef __linux__
+    int i;
+    for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+    {
+        if (profile -> perfFds[i] >= 0)
+        {
+            ioctl(profile -> perfFds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(profile -> perfFds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+    profile -> startSeconds = wallSeconds();
+    profile -> startTicks = profile -> last = readProfileTicks();
+}
+
+
+void stopProfile(CacheSimProfile *profile)
+{
+    profile -> totalTicks = readProfileTicks() - profile -> startTicks;
+    profile -> seconds = wallSeconds() - profile -> startSeconds;
+#ifdef __linux__
+    int i;
+    for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+    {
+        if (profile -> perfFds[i] >= 0)
+        {
+            ioctl(profile -> perfFds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(profile -> perfFds[i], &profile -> perfValues[i], sizeof(unsigned long long int)) != sizeof(unsigned long long int))
+            {
+                profile -> perfValues[i] = 0;
+            }
+        }
+    }
+#endif
+}
+
+
+void printProfile(const CacheSimProfile *profile, unsigned long long int accesses)
+{
+    /* Ticks are converted to seconds by the run's ticks per wall-clock second */
+    double total = profile -> totalTicks ? (double) profile -> totalTicks : 1;
+
+    printf("-----\nProfile\n-----\n");
+    printf("Accesses: %llu\n", accesses);
+    printf("Seconds: %.3f\n", profile -> seconds);
+    printf("Accesses per second: %.0f\n", profile -> seconds > 0 ? accesses / profile -> seconds : 0);
+    printf("Ticks per second: %.0f\n", profile -> seconds > 0 ? profile -> totalTicks / profile -> seconds : 0);
+    int i;
+    for (i = 0; i < PROFILE_PHASES; i++)
+    {
+        double seconds = profile -> ticks[i] / total * profile -> seconds;
+        printf("%s: %.3f s (%.1f%%), %llu times, %.1f ns each\n", phaseNames[i], seconds, 100.0 * profile -> ticks[i] / total,
+               profile -> marks[i], profile -> marks[i] ? seconds * 1e9 / profile -> marks[i] : 0);
+    }
+
+    int opened = 0;
+    for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+    {
+        if (profile -> perfFds[i] >= 0)
+        {
+            printf("%s: %llu\n", perfNames[i], profile -> perfValues[i]);
+            opened = 1;
+        }
+    }
+    if (profile -> perfError)
+    {
+        printf("Hardware counters%s unavailable: %s\n", opened ? " partly" : "", strerror(profile -> perfError));
+    }
+    if (opened && profile -> perfFds[0] >= 0 && accesses)
+    {
+        printf("Cycles per access: %.1f\n", (double) profile -> perfValues[0] / accesses);
+    }
+}
+
+
+void freeProfile(CacheSimProfile *profile)
+{
+    int i;
+    for (i = 0; i < PROFILE_PERF_COUNTERS; i++)
+    {
+        if (profile -> perfFds[i] >= 0)
+        {
+            close(profile -> perfFds[i]);
+        }
+    }
+    free(profile);
+}
+
+
+static double wallSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+static int openPerfCounter(int counter)
+{
+    /* Counts the calling thread in user space only, from startProfile to stopProfile */
+#ifdef __linux__
+    static const unsigned long long int configs[PROFILE_PERF_COUNTERS] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[counter];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  profile.h
+ *
+ *    Description:  Opt-in self-profiling: cycle-counter phase timers around the
+ *                  simulator's own work, and optional hardware counters through
+ *                  perf_event_open, reported with the run's accesses per second.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "libcachesim.h"
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* The phases time is charged to; each mark charges the time since the last mark */
+#define PROFILE_PARSE 0
+#define PROFILE_TLB 1
+#define PROFILE_DECODE 2
+#define PROFILE_L1 3
+#define PROFILE_L2 4
+#define PROFILE_OTHER 5
+#define PROFILE_OUTPUT 6
+#define PROFILE_PHASES 7
+
+/* Hardware counters: cycles, last-level cache misses and branch misses */
+#define PROFILE_PERF_COUNTERS 3
+
+struct cacheSimProfile
+{
+    /* Ticks charged to each phase, and how many times it was marked */
+    unsigned long long int ticks[PROFILE_PHASES];
+    unsigned long long int marks[PROFILE_PHASES];
+    /* The tick count at the last mark */
+    unsigned long long int last;
+    /* The run's ticks and wall time, from startProfile to stopProfile */
+    unsigned long long int startTicks, totalTicks;
+    double startSeconds, seconds;
+    /* perf_event_open descriptors, -1 where a counter could not be opened */
+    int perfFds[PROFILE_PERF_COUNTERS];
+    /* errno from the first counter that failed to open, or 0 */
+    int perfError;
+    unsigned long long int perfValues[PROFILE_PERF_COUNTERS];
+};
+
+/* The cycle counter where there is one, otherwise nanoseconds */
+static inline unsigned long long int readProfileTicks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/* Charge the time since the last mark to phase */
+static inline void markProfile(CacheSimProfile *profile, int phase)
+{
+    unsigned long long int now = readProfileTicks();
+    profile -> ticks[phase] += now - profile -> last;
+    profile -> marks[phase]++;
+    profile -> last = now;
+}
+
+/* Create a profile; with perfCounters, also open the hardware counters for the calling thread.
+ * Returns NULL if it cannot be allocated */
+CacheSimProfile *createProfile(int perfCounters);
+
+/* Zero the phases and start the clocks and counters */
+void startProfile(CacheSimProfile *profile);
+
+/* Stop the clocks and read the counters */
+void stopProfile(CacheSimProfile *profile);
+
+/* Print the time in each phase and how often it ran (the L1 and L2 phases count lookups
+ * in both hierarchies), and accesses per second */
+void printProfile(const CacheSimProfile *profile, unsigned long long int accesses);
+
+void freeProfile(CacheSimProfile *profile);
+
+#endif
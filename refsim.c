@@ -0,0 +1,422 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  refsim.c
+ *
+ *    Description:  The reference engine. fetch, updateLRU and evict are the original
+ *                  simulator's, renamed, with the evicted block no longer printed;
+ *                  refAccess is its main loop body, reading every L2 block of an
+ *                  L1 block larger than L2's. Nothing here is meant to be
+ *                  fast: it is the definition the optimized engines are held to.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "refsim.h"
+#include <stdlib.h>
+
+/* Addresses are 48 bits, as in the original */
+#define REF_ADDRESS_BITS 48
+
+static int refHash(unsigned long long int n, int size);
+static int compareUsage(const void *a, const void *b);
+static int refIsPowerOfTwo(int n);
+static int refLogBase2(int n);
+static unsigned long long int refGetTag(unsigned long long int address, int setBits, int tagBits, int blockOffset);
+static void refUpdateLRU(RefCache *cache, int tagIndex, int setIndex, int numLines);
+static int refEvict(RefCache *cache, unsigned long long int tag, int setIndex, int numLines);
+static int refAccessHierarchy(RefCache *l1Cache, RefCache *l2Cache, CacheSimCounters *counters, int prefetching,
+                              unsigned long long int address, char operation);
+
+
+RefCache *refCreateCache(int size, int associativity, int blockSize)
+{
+    if (!refIsPowerOfTwo(size) || !refIsPowerOfTwo(blockSize) || blockSize > size ||
+        (associativity && (!refIsPowerOfTwo(associativity) || associativity > size / blockSize)))
+    {
+        return 0;
+    }
+
+    RefCache *cache = (RefCache *) malloc(sizeof(RefCache));
+    cache -> blockSize = blockSize;
+    cache -> numLines = associativity ? associativity : size / blockSize;
+    cache -> numSets = size / blockSize / cache -> numLines;
+    cache -> blockOffsetBits = refLogBase2(blockSize);
+    cache -> setBits = refLogBase2(cache -> numSets);
+    cache -> tagBits = REF_ADDRESS_BITS - cache -> blockOffsetBits - cache -> setBits;
+
+    /* Allocate the Cache's table of Sets, and each Set's Lines */
+    cache -> sets = (RefSet *) malloc(cache -> numSets * sizeof(RefSet));
+    int i;
+    for (i = 0; i < cache -> numSets; i++)
+    {
+        cache -> sets[i].numItems = 0;
+        cache -> sets[i].lines = (RefLine *) calloc(cache -> numLines, sizeof(RefLine));
+    }
+
+    return cache;
+}
+
+
+void refFreeCache(RefCache *cache)
+{
+    int i;
+    for (i = 0; i < cache -> numSets; i++)
+    {
+        free(cache -> sets[i].lines);
+    }
+    free(cache -> sets);
+    free(cache);
+}
+
+
+unsigned long int refGetSet(RefCache *cache, unsigned long long int address)
+{
+    /* The setBits bits above the block offset */
+    return (address >> cache -> blockOffsetBits) & ((1ULL << cache -> setBits) - 1);
+}
+
+
+int refGetSetBlocks(RefCache *cache, unsigned long int set, unsigned long long int *blocks)
+{
+    /* Order the valid Lines by usage: usages are distinct, and 1 is the most recent */
+    RefSet *s = &cache -> sets[set];
+    RefLine *lines = (RefLine *) malloc(cache -> numLines * sizeof(RefLine));
+    int numBlocks = 0;
+    int i;
+    for (i = 0; i < cache -> numLines; i++)
+    {
+        if (s -> lines[i].valid)
+        {
+            lines[numBlocks++] = s -> lines[i];
+        }
+    }
+    qsort(lines, numBlocks, sizeof(RefLine), compareUsage);
+    for (i = 0; i < numBlocks; i++)
+    {
+        blocks[i] = (lines[i].tag << cache -> setBits) | set;
+    }
+    free(lines);
+
+    return numBlocks;
+}
+
+
+int refFetch(RefCache *cache, int prefetching, unsigned long long int address)
+{
+    /* Return 1 on a Cache Hit, 0 on a Cache Miss */
+    int hit = 0;
+    int numLines = cache -> numLines;
+    unsigned long long int tag = refGetTag(address, cache -> setBits, cache -> tagBits, cache -> blockOffsetBits);
+    unsigned long int set = refGetSet(cache, address);
+
+    /* Hash the Tag and the Set */
+    int tagIndex = refHash(tag, numLines);
+    int setIndex = refHash(set, cache -> numSets);
+
+    /* Index into the Cache and retrieve the proper Valid bit and Tag */
+    int validBit = cache -> sets[setIndex].lines[tagIndex].valid;
+    unsigned long long int currentTag = cache -> sets[setIndex].lines[tagIndex].tag;
+
+    /* If the Valid bit is 1 and the current Tag at tagIndex matches the new Tag, Cache Hit */
+    if (validBit && (currentTag == tag))
+    {
+        hit = 1;
+    }
+    /* If the Valid bit is 1 and the current Tag at tagIndex does not match the new Tag */
+    else if (validBit && (currentTag != tag))
+    {
+        /* Linearly probe the adjacent Lines in the Set;
+         * If the Valid bit is 1 and the current Tag at ((tagIndex + i) % numLines) matches the new Tag, Cache Hit)
+         * If no matches are found, Cache Miss, evict LRU from cache and bring new address into cache
+         */
+        int i, iIndex, iValid, found = 0;
+        unsigned long long int iTag = 0;
+        for (i = 1; i < numLines; i++)
+        {
+            iIndex = refHash(tagIndex + i, numLines);
+            iValid = cache -> sets[setIndex].lines[iIndex].valid;
+            iTag = cache -> sets[setIndex].lines[iIndex].tag;
+
+            /* If the Valid bit is 1 and the current Tag at ((tagIndex + i) % numLines) matches the new Tag, Cache Hit */
+            if (iValid && (iTag == tag))
+            {
+                hit = 1, found = 1;
+                tagIndex = iIndex;
+                break;
+            }
+        }
+        /* If no matches are found, Cache Miss */
+        if (!found)
+        {
+            hit = 0;
+
+            /* If Set is not full */
+            if (cache -> sets[setIndex].numItems < numLines)
+            {
+                /* Search for an empty space */
+                for (i = 1; i < numLines; i++)
+                {
+                    iIndex = refHash(tagIndex + i, numLines);
+                    iValid = cache -> sets[setIndex].lines[iIndex].valid;
+
+                    /* If the Valid bit is 0, Cache Miss, bring new address into the Cache, write into empty location */
+                    if (!iValid)
+                    {
+                        cache -> sets[setIndex].lines[iIndex].valid = 1;
+                        cache -> sets[setIndex].lines[iIndex].tag = tag;
+                        cache -> sets[setIndex].numItems++;
+                        tagIndex = iIndex;
+                        break;
+                    }
+                }
+            }
+            /* If Set is full */
+            else if (cache -> sets[setIndex].numItems == numLines)
+            {
+                /* Evict LRU from cache and bring address into cache */
+                tagIndex = refEvict(cache, tag, setIndex, numLines);
+            }
+        }
+    }
+    /* If the Valid bit is not 1, Cache Miss */
+    else if (!validBit)
+    {
+        hit = 0;
+
+        /* Bring new address into the Cache, write into empty location */
+        cache -> sets[setIndex].lines[tagIndex].valid = 1;
+        cache -> sets[setIndex].lines[tagIndex].tag = tag;
+        cache -> sets[setIndex].numItems++;
+    }
+
+    if (!prefetching || !hit)
+    {
+        /* Update the blocks' Least Recently Used properties */
+        refUpdateLRU(cache, tagIndex, setIndex, numLines);
+    }
+
+    return hit;
+}
+
+
+RefSim *refCreateSim(const CacheSimConfig *config)
+{
+    /* The original had no index functions, victim caches or TLBs */
+    if (config -> l1.indexFunction != CACHESIM_INDEX_MODULO || config -> l2.indexFunction != CACHESIM_INDEX_MODULO ||
+        config -> l1.victimEntries || config -> l2.victimEntries || config -> dtlb.entries)
+    {
+        return 0;
+    }
+
+    RefSim *sim = (RefSim *) calloc(1, sizeof(RefSim));
+    sim -> l1NoPrefetchCache = refCreateCache(config -> l1.size, config -> l1.associativity, config -> l1.blockSize);
+    sim -> l1WithPrefetchCache = refCreateCache(config -> l1.size, config -> l1.associativity, config -> l1.blockSize);
+    sim -> l2NoPrefetchCache = refCreateCache(config -> l2.size, config -> l2.associativity, config -> l2.blockSize);
+    sim -> l2WithPrefetchCache = refCreateCache(config -> l2.size, config -> l2.associativity, config -> l2.blockSize);
+    if (!sim -> l1NoPrefetchCache || !sim -> l1WithPrefetchCache || !sim -> l2NoPrefetchCache || !sim -> l2WithPrefetchCache)
+    {
+        refFreeSim(sim);
+        return 0;
+    }
+
+    return sim;
+}
+
+
+int refAccess(RefSim *sim, unsigned long long int address, char operation, int *prefetchResult)
+{
+    sim -> stats.noPrefetch.totalInstructions++;
+    sim -> stats.withPrefetch.totalInstructions++;
+
+    *prefetchResult = CACHESIM_MEMORY;
+    if (operation != 'R' && operation != 'W')
+    {
+        return CACHESIM_MEMORY;
+    }
+
+    *prefetchResult = refAccessHierarchy(sim -> l1WithPrefetchCache, sim -> l2WithPrefetchCache, &sim -> stats.withPrefetch,
+                                         1, address, operation);
+    return refAccessHierarchy(sim -> l1NoPrefetchCache, sim -> l2NoPrefetchCache, &sim -> stats.noPrefetch,
+                              0, address, operation);
+}
+
+
+void refFreeSim(RefSim *sim)
+{
+    RefCache *caches[] = { sim -> l1NoPrefetchCache, sim -> l1WithPrefetchCache, sim -> l2NoPrefetchCache, sim -> l2WithPrefetchCache };
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        if (caches[i])
+        {
+            refFreeCache(caches[i]);
+        }
+    }
+    free(sim);
+}
+
+
+static int refAccessHierarchy(RefCache *l1Cache, RefCache *l2Cache, CacheSimCounters *counters, int prefetching,
+                              unsigned long long int address, char operation)
+{
+    int result;
+
+    /* Check L1 cache */
+    if (refFetch(l1Cache, 0, address))
+    {
+        counters -> l1CacheHits++;
+        result = CACHESIM_L1_HIT;
+    }
+    else
+    {
+        counters -> l1CacheMisses++;
+
+        /* Check L2 cache, for each L2 block of the L1 block if the L1 block is larger */
+        unsigned long long int next = address + l2Cache -> blockSize;
+        int lookups = 1, missed = 0, i;
+        if (l1Cache -> blockSize > l2Cache -> blockSize)
+        {
+            address -= address % l1Cache -> blockSize;
+            next = address + l1Cache -> blockSize;
+            lookups = l1Cache -> blockSize / l2Cache -> blockSize;
+        }
+        for (i = 0; i < lookups; i++)
+        {
+            if (refFetch(l2Cache, 0, address + (unsigned long long int) i * l2Cache -> blockSize))
+            {
+                counters -> l2CacheHits++;
+            }
+            else
+            {
+                counters -> l2CacheMisses++;
+                counters -> memoryReads++;
+                missed = 1;
+            }
+        }
+        result = missed ? CACHESIM_MEMORY : CACHESIM_L2_HIT;
+        if (missed)
+        {
+            counters -> overallMisses++;
+        }
+
+        /* Prefetch the next block; read it from memory if it is not already in L2 */
+        if (missed && prefetching && !refFetch(l2Cache, 1, next))
+        {
+            counters -> memoryReads++;
+        }
+    }
+
+    if (operation == 'W')
+    {
+        counters -> memoryWrites++;
+    }
+
+    return result;
+}
+
+
+static int refHash(unsigned long long int n, int size)
+{
+    return n % size;
+}
+
+
+static int compareUsage(const void *a, const void *b)
+{
+    unsigned long int x = ((const RefLine *) a) -> usage, y = ((const RefLine *) b) -> usage;
+    return (x > y) - (x < y);
+}
+
+
+static int refIsPowerOfTwo(int n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+
+static int refLogBase2(int n)
+{
+    /* Continue shifting right until n is 0 */
+    int log = 0;
+    while (n - 1 > 0)
+    {
+        n = n >> 1;
+        log++;
+    }
+
+    return log;
+}
+
+
+static unsigned long long int refGetTag(unsigned long long int address, int setBits, int tagBits, int blockOffset)
+{
+    /* The mask that will be used to get the ith bit */
+    unsigned long long int mask = 1;
+
+    /* Shift address right by blockOffset and setBits */
+    address = address >> (blockOffset + setBits);
+
+    /* For each bit after the blockOffset and setBits */
+    unsigned long long int tag = 0;
+    int i;
+    for (i = 0; i < tagBits; i++)
+    {
+        /* AND the ith bit of address with mask, and add it to tag */
+        tag += address & mask;
+
+        /* Shift mask left */
+        mask = mask << 1;
+    }
+
+    return tag;
+}
+
+
+static void refUpdateLRU(RefCache *cache, int tagIndex, int setIndex, int numLines)
+{
+    /* Assume that the block at [setIndex][tagIndex] has been used.
+     * Update the usage of each line in the set. */
+    int i;
+    for (i = 0; i < numLines; i++)
+    {
+        /* If the current line is the line that was just used */
+        if (i == tagIndex)
+        {
+            /* This line is most recently used */
+            cache -> sets[setIndex].lines[i].usage = 1;
+        }
+        /* Otherwise, if the current line has been used */
+        else if (cache -> sets[setIndex].lines[i].usage > 0)
+        {
+            /* Increment usage */
+            cache -> sets[setIndex].lines[i].usage++;
+        }
+    }
+}
+
+
+static int refEvict(RefCache *cache, unsigned long long int tag, int setIndex, int numLines)
+{
+    /* Find the Least Recently Used block and replace it with the given block */
+    int indexOfLRU = 0;
+    long int max = 0;
+    int i;
+
+    for (i = 0; i < numLines; i++)
+    {
+        if (cache -> sets[setIndex].lines[i].usage > max)
+        {
+            max = cache -> sets[setIndex].lines[i].usage;
+            indexOfLRU = i;
+        }
+    }
+
+    cache -> sets[setIndex].lines[indexOfLRU].tag = tag;
+
+    return indexOfLRU;
+}
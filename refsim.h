@@ -0,0 +1,89 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  refsim.h
+ *
+ *    Description:  The reference engine: the original simulator's caches, kept as
+ *                  they were before the engine was optimized. Each Set is its own
+ *                  array of Lines, a block is placed by probing from its tag's hash,
+ *                  and LRU is kept with usage counters. cachesim-verify runs it in
+ *                  lockstep with the optimized engines to show they still agree.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef REFSIM_H
+#define REFSIM_H
+
+#include "libcachesim.h"
+
+typedef struct refLine RefLine;
+struct refLine
+{
+    int valid;
+    unsigned long long int tag;
+    /* 0 if never used, 1 for the most recently used, larger for older */
+    unsigned long int usage;
+};
+
+typedef struct refSet RefSet;
+struct refSet
+{
+    int numItems;
+    RefLine *lines;
+};
+
+typedef struct refCache RefCache;
+struct refCache
+{
+    RefSet *sets;
+    int numSets;
+    int numLines;
+    int blockSize;
+    int blockOffsetBits;
+    int setBits;
+    int tagBits;
+};
+
+/* Where each access was satisfied in each hierarchy, as the original main loop
+ * counted it; the counters are those of a CacheSim without victim caches or TLBs */
+typedef struct refSim RefSim;
+struct refSim
+{
+    RefCache *l1NoPrefetchCache;
+    RefCache *l1WithPrefetchCache;
+    RefCache *l2NoPrefetchCache;
+    RefCache *l2WithPrefetchCache;
+    CacheSimStats stats;
+};
+
+/* Create an empty cache; associativity is 1 for direct mapped, 0 for fully associative.
+ * Only power-of-2 geometries with the modulo index have a reference */
+RefCache *refCreateCache(int size, int associativity, int blockSize);
+void refFreeCache(RefCache *cache);
+
+/* Look address up, bringing its block in on a miss; returns 1 on a hit, 0 on a miss.
+ * A prefetch hit leaves the LRU order alone, as in the original */
+int refFetch(RefCache *cache, int prefetching, unsigned long long int address);
+
+/* The Set address maps to */
+unsigned long int refGetSet(RefCache *cache, unsigned long long int address);
+
+/* Write the block addresses held by set into blocks, most recently used first; returns how many */
+int refGetSetBlocks(RefCache *cache, unsigned long int set, unsigned long long int *blocks);
+
+/* Both reference hierarchies for config; returns NULL if config has no reference */
+RefSim *refCreateSim(const CacheSimConfig *config);
+
+/* Simulate one access as the original main loop did; returns CACHESIM_L1_HIT,
+ * CACHESIM_L2_HIT or CACHESIM_MEMORY for the hierarchy without prefetching, and
+ * the same for the hierarchy with prefetching in prefetchResult */
+int refAccess(RefSim *sim, unsigned long long int address, char operation, int *prefetchResult);
+
+void refFreeSim(RefSim *sim);
+
+#endif
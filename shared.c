@@ -0,0 +1,402 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shared.c
+ *
+ *    Description:  Co-scheduled tenants sharing an L2, with way partitioning and
+ *                  utility-based cache partitioning
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "shared.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int lookupRank(Cache *cache, unsigned long long int tag, unsigned long int set);
+static int accessSharedL2(SharedCache *shared, int tenant, unsigned long long int tag, unsigned long int set);
+static int chooseVictim(SharedCache *shared, int tenant, Line *lines, int numLines);
+static void repartition(SharedCache *shared);
+
+
+SharedCache *createSharedCache(const CacheSimConfig *config, int numTenants, int partition, const int *ways,
+                               unsigned long int interval, char *error, size_t errorLength)
+{
+    if (cacheSimCheckConfig(config, error, errorLength))
+    {
+        return 0;
+    }
+    if (numTenants < 1 || numTenants > SHARED_MAX_TENANTS)
+    {
+        snprintf(error, errorLength, "between 1 and %d tenants can share L2.", SHARED_MAX_TENANTS);
+        return 0;
+    }
+    if (config -> l2.indexFunction == CACHESIM_INDEX_SKEWED)
+    {
+        snprintf(error, errorLength, "a shared L2 cannot be skewed-associative.");
+        return 0;
+    }
+    if (config -> l1.victimEntries || config -> l2.victimEntries)
+    {
+        snprintf(error, errorLength, "victim and miss caches are not modelled with a shared L2.");
+        return 0;
+    }
+    if (config -> l1.sectors > 1 || config -> l2.sectors > 1)
+    {
+        snprintf(error, errorLength, "sectored caches are not modelled with a shared L2.");
+        return 0;
+    }
+    if (config -> dram.channels)
+    {
+        snprintf(error, errorLength, "DRAM is not modelled with a shared L2.");
+        return 0;
+    }
+    if (partition < PARTITION_NONE || partition > PARTITION_UCP || (partition == PARTITION_UCP && interval == 0))
+    {
+        snprintf(error, errorLength, "invalid L2 partitioning policy.");
+        return 0;
+    }
+
+    int l1Ways = config -> l1.associativity ? config -> l1.associativity : config -> l1.size / config -> l1.blockSize;
+    int l2Ways = config -> l2.associativity ? config -> l2.associativity : config -> l2.size / config -> l2.blockSize;
+
+    /* Every tenant needs at least one way of each set */
+    int t, total = 0;
+    if (partition != PARTITION_NONE && l2Ways < numTenants)
+    {
+        snprintf(error, errorLength, "L2 has fewer ways than there are tenants to partition them between.");
+        return 0;
+    }
+    if (partition == PARTITION_WAYS)
+    {
+        for (t = 0; t < numTenants; t++)
+        {
+            if (ways[t] < 1)
+            {
+                snprintf(error, errorLength, "every tenant needs at least one L2 way.");
+                return 0;
+            }
+            total += ways[t];
+        }
+        if (total != l2Ways)
+        {
+            snprintf(error, errorLength, "the way partitions add up to %d, not to the %d L2 ways.", total, l2Ways);
+            return 0;
+        }
+    }
+
+    SharedCache *shared = (SharedCache *) calloc(1, sizeof(SharedCache));
+    if (shared == 0)
+    {
+        snprintf(error, errorLength, "could not allocate the shared L2.");
+        return 0;
+    }
+    shared -> numTenants = numTenants;
+    shared -> partition = partition;
+    shared -> interval = interval;
+    shared -> l2 = createCache(config -> l2.size, l2Ways, config -> l2.blockSize, config -> hugePages, config -> l2.indexFunction);
+    if (shared -> l2 == 0)
+    {
+        snprintf(error, errorLength, "could not allocate the shared L2.");
+        freeSharedCache(shared);
+        return 0;
+    }
+
+    /* The tenant number goes in the bits just above the tag, which the address never reaches */
+    shared -> tenantShift = shared -> l2 -> tagBits;
+    if (shared -> tenantShift + SHARED_TENANT_BITS > LINE_TAG_BITS)
+    {
+        snprintf(error, errorLength, "L2 blocks and sets are too small to leave room for tenant numbers in its tags.");
+        freeSharedCache(shared);
+        return 0;
+    }
+
+    for (t = 0; t < numTenants; t++)
+    {
+        SharedTenant *tenant = &shared -> tenants[t];
+        tenant -> l1 = createCache(config -> l1.size, l1Ways, config -> l1.blockSize, config -> hugePages, config -> l1.indexFunction);
+        tenant -> alone = createCache(config -> l2.size, l2Ways, config -> l2.blockSize, config -> hugePages, config -> l2.indexFunction);
+        tenant -> rankHits = (unsigned long long int *) calloc(l2Ways, sizeof(unsigned long long int));
+        if (tenant -> l1 == 0 || tenant -> alone == 0 || tenant -> rankHits == 0)
+        {
+            snprintf(error, errorLength, "could not allocate the tenants' caches.");
+            freeSharedCache(shared);
+            return 0;
+        }
+
+        /* UCP starts from an even split, the first tenants taking what is left over */
+        if (partition == PARTITION_WAYS)
+        {
+            tenant -> ways = ways[t];
+        }
+        else
+        {
+            tenant -> ways = l2Ways / numTenants + (t < l2Ways % numTenants);
+        }
+    }
+
+    return shared;
+}
+
+
+int accessSharedCache(SharedCache *shared, int tenant, unsigned long long int address, char operation)
+{
+    SharedTenant *owner = &shared -> tenants[tenant];
+    CacheSimCounters *counters = &owner -> counters;
+    counters -> totalInstructions++;
+
+    /* Only Reads and Writes touch the caches */
+    if (operation != 'R' && operation != 'W')
+    {
+        return CACHESIM_MEMORY;
+    }
+
+    /* Writes go through to memory, whether or not they hit */
+    if (operation == 'W')
+    {
+        counters -> memoryWrites++;
+    }
+
+    /* Check the tenant's L1 cache */
+    Cache *l1Cache = owner -> l1;
+    if (fetch(l1Cache, 0, getBlockTag(l1Cache, address), getBlockSet(l1Cache, address), l1Cache -> numLines, l1Cache -> numSets))
+    {
+        counters -> l1CacheHits++;
+        return CACHESIM_L1_HIT;
+    }
+    counters -> l1CacheMisses++;
+
+    /* An L1 block larger than L2's is filled from each L2 block it covers, in order */
+    Cache *alone = owner -> alone;
+    Cache *l2Cache = shared -> l2;
+    int lookups = 1, hit = 1, i;
+    if (l1Cache -> blockSize > l2Cache -> blockSize)
+    {
+        address &= ~(unsigned long long int) (l1Cache -> blockSize - 1);
+        lookups = l1Cache -> blockSize / l2Cache -> blockSize;
+    }
+    for (i = 0; i < lookups; i++, address += l2Cache -> blockSize)
+    {
+        /* The L2 the tenant would have to itself; where it hits in the LRU order is its utility */
+        unsigned long long int tag = getBlockTag(alone, address);
+        unsigned long int set = getBlockSet(alone, address);
+        int rank = lookupRank(alone, tag, set);
+        if (rank >= 0)
+        {
+            owner -> rankHits[rank]++;
+        }
+        else
+        {
+            owner -> aloneL2Misses++;
+        }
+        fetch(alone, 0, tag, set, alone -> numLines, alone -> numSets);
+
+        /* The shared L2, where the tenant's blocks carry its number */
+        tag = getBlockTag(l2Cache, address) | ((unsigned long long int) tenant << shared -> tenantShift);
+        if (accessSharedL2(shared, tenant, tag, getBlockSet(l2Cache, address)))
+        {
+            counters -> l2CacheHits++;
+        }
+        else
+        {
+            counters -> l2CacheMisses++;
+            counters -> memoryReads++;
+            hit = 0;
+        }
+    }
+    if (!hit)
+    {
+        counters -> overallMisses++;
+    }
+
+    if (shared -> partition == PARTITION_UCP && ++shared -> sinceRepartition == shared -> interval)
+    {
+        repartition(shared);
+    }
+
+    return hit ? CACHESIM_L2_HIT : CACHESIM_MEMORY;
+}
+
+
+void freeSharedCache(SharedCache *shared)
+{
+    int t;
+    for (t = 0; t < shared -> numTenants; t++)
+    {
+        freeCache(shared -> tenants[t].l1);
+        freeCache(shared -> tenants[t].alone);
+        free(shared -> tenants[t].rankHits);
+    }
+    freeCache(shared -> l2);
+    free(shared);
+}
+
+
+static int lookupRank(Cache *cache, unsigned long long int tag, unsigned long int set)
+{
+    /* Return the LRU rank of the Line holding tag (0 for the most recently used), or -1 if it is not cached */
+    int setIndex = hash(set, cache -> numSets);
+    Line *lines = cache -> lines + (size_t) setIndex * cache -> numLines;
+    unsigned int numItems = cache -> numItems[setIndex];
+    Line wanted = LINE_VALID | tag;
+    unsigned int i;
+    for (i = 0; i < numItems; i++)
+    {
+        if ((lines[i] & (LINE_VALID | LINE_TAG_MASK)) == wanted)
+        {
+            return (int) ((lines[i] & LINE_RANK_MASK) >> LINE_RANK_SHIFT);
+        }
+    }
+    return -1;
+}
+
+
+static int accessSharedL2(SharedCache *shared, int tenant, unsigned long long int tag, unsigned long int set)
+{
+    /* Return 1 on a Cache Hit, 0 on a Cache Miss; as fetch, but a full Set picks its
+     * victim by the partitioning policy */
+    Cache *cache = shared -> l2;
+    int numLines = cache -> numLines;
+    int setIndex = hash(set, cache -> numSets);
+    Line *lines = cache -> lines + (size_t) setIndex * numLines;
+    unsigned int numItems = cache -> numItems[setIndex];
+    Line wanted = LINE_VALID | tag;
+    int tagIndex;
+    unsigned int i;
+
+    for (i = 0; i < numItems; i++)
+    {
+        if ((lines[i] & (LINE_VALID | LINE_TAG_MASK)) == wanted)
+        {
+            updateLRU(cache, i, setIndex, numLines);
+            return 1;
+        }
+    }
+
+    /* If Set is not full, write into the next empty Line, as the least recently used */
+    if (numItems < numLines)
+    {
+        tagIndex = numItems;
+        lines[tagIndex] = LINE_VALID | ((Line) numItems << LINE_RANK_SHIFT) | tag;
+        cache -> numItems[setIndex]++;
+    }
+    /* If Set is full, replace the chosen Line, keeping its rank until updateLRU */
+    else
+    {
+        tagIndex = chooseVictim(shared, tenant, lines, numLines);
+        int victimTenant = (int) ((lines[tagIndex] & LINE_TAG_MASK) >> shared -> tenantShift);
+        if (victimTenant != tenant)
+        {
+            shared -> tenants[victimTenant].evictedByOthers++;
+        }
+        lines[tagIndex] = LINE_VALID | (lines[tagIndex] & LINE_RANK_MASK) | tag;
+    }
+    updateLRU(cache, tagIndex, setIndex, numLines);
+
+    return 0;
+}
+
+
+static int chooseVictim(SharedCache *shared, int tenant, Line *lines, int numLines)
+{
+    /* Pick the Line of a full Set to replace for tenant. Unpartitioned, it is the least
+     * recently used. Partitioned, a tenant under its ways takes the least recently used
+     * Line of the tenants over theirs; otherwise it replaces its own least recently used */
+    int counts[SHARED_MAX_TENANTS];
+    int i, owner, victim = -1;
+    Line oldest = 0;
+
+    if (shared -> partition != PARTITION_NONE)
+    {
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < numLines; i++)
+        {
+            counts[(lines[i] & LINE_TAG_MASK) >> shared -> tenantShift]++;
+        }
+
+        int underQuota = counts[tenant] < shared -> tenants[tenant].ways;
+        for (i = 0; i < numLines; i++)
+        {
+            owner = (int) ((lines[i] & LINE_TAG_MASK) >> shared -> tenantShift);
+            int candidate = underQuota ? counts[owner] > shared -> tenants[owner].ways : owner == tenant;
+            if (candidate && (victim < 0 || (lines[i] & LINE_RANK_MASK) > oldest))
+            {
+                victim = i;
+                oldest = lines[i] & LINE_RANK_MASK;
+            }
+        }
+        if (victim >= 0)
+        {
+            return victim;
+        }
+    }
+
+    /* The Line ranked least recently used */
+    Line lruRank = (Line) (numLines - 1) << LINE_RANK_SHIFT;
+    for (i = 0; i < numLines; i++)
+    {
+        if ((lines[i] & LINE_RANK_MASK) == lruRank)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+static void repartition(SharedCache *shared)
+{
+    /* The lookahead algorithm of utility-based cache partitioning: starting from one way
+     * each, repeatedly give the tenant with the most hits gained per extra way the extra
+     * ways that achieve it, until every way is allocated. Then halve the hit counters,
+     * so the next allocation favours recent behaviour */
+    int numLines = shared -> l2 -> numLines;
+    int allocation[SHARED_MAX_TENANTS];
+    int balance = numLines - shared -> numTenants;
+    int t, k;
+
+    for (t = 0; t < shared -> numTenants; t++)
+    {
+        allocation[t] = 1;
+    }
+
+    while (balance > 0)
+    {
+        int bestTenant = 0, bestWays = balance;
+        double bestUtility = -1;
+        for (t = 0; t < shared -> numTenants; t++)
+        {
+            unsigned long long int *rankHits = shared -> tenants[t].rankHits;
+            unsigned long long int gained = 0;
+            for (k = 1; k <= balance; k++)
+            {
+                gained += rankHits[allocation[t] + k - 1];
+                double utility = (double) gained / k;
+                if (utility > bestUtility)
+                {
+                    bestUtility = utility;
+                    bestTenant = t;
+                    bestWays = k;
+                }
+            }
+        }
+        allocation[bestTenant] += bestWays;
+        balance -= bestWays;
+    }
+
+    for (t = 0; t < shared -> numTenants; t++)
+    {
+        shared -> tenants[t].ways = allocation[t];
+        for (k = 0; k < numLines; k++)
+        {
+            shared -> tenants[t].rankHits[k] /= 2;
+        }
+    }
+    shared -> sinceRepartition = 0;
+    shared -> repartitions++;
+}
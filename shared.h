@@ -0,0 +1,85 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  shared.h
+ *
+ *    Description:  Co-scheduled tenants sharing an L2. Each tenant has a private L1
+ *                  and competes for one shared L2, which can be left shared, split
+ *                  into fixed way partitions, or repartitioned by utility (UCP).
+ *                  Every tenant also runs through an L2 of its own, so the misses
+ *                  caused by sharing can be told apart from its own.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#include "cache-sim.h"
+#include "libcachesim.h"
+#include <stddef.h>
+
+/* Tenants are told apart in the shared L2 by this many bits above each tag */
+#define SHARED_TENANT_BITS 4
+#define SHARED_MAX_TENANTS (1 << SHARED_TENANT_BITS)
+
+/* L2 partitioning policies */
+/* One LRU over every tenant's blocks */
+#define PARTITION_NONE 0
+/* Each tenant may hold a fixed number of ways of every set */
+#define PARTITION_WAYS 1
+/* Utility-based: the ways are redistributed every interval L2 accesses by the
+ * lookahead algorithm, from each tenant's hits at each LRU position */
+#define PARTITION_UCP 2
+
+#define SHARED_DEFAULT_UCP_INTERVAL 100000
+
+typedef struct sharedTenant SharedTenant;
+struct sharedTenant
+{
+    Cache *l1;
+    /* The L2 as the tenant would have it to itself; also its UCP utility monitor */
+    Cache *alone;
+    /* Counters, as for the hierarchy without prefetching */
+    CacheSimCounters counters;
+    unsigned long long int aloneL2Misses;
+    /* The tenant's L2 blocks evicted to make room for another tenant's */
+    unsigned long long int evictedByOthers;
+    /* Hits in the alone L2 at each LRU rank since the last repartition, halved at each one */
+    unsigned long long int *rankHits;
+    /* The ways of each L2 set the tenant may hold, if partitioned */
+    int ways;
+};
+
+typedef struct sharedCache SharedCache;
+struct sharedCache
+{
+    int numTenants;
+    int partition;
+    Cache *l2;
+    /* A tenant's number is stored at this bit of its L2 tags */
+    int tenantShift;
+    unsigned long int interval;
+    unsigned long int sinceRepartition;
+    unsigned long int repartitions;
+    SharedTenant tenants[SHARED_MAX_TENANTS];
+};
+
+/* Create numTenants private L1s of config -> l1 and a shared L2 of config -> l2.
+ * ways gives each tenant's ways for PARTITION_WAYS, and must add up to the L2
+ * associativity; UCP starts from an even split and repartitions every interval L2
+ * accesses. Only the hierarchy without prefetching is modelled, and the L2 may not
+ * be skewed. Returns NULL and writes a message into error if the setup is invalid */
+SharedCache *createSharedCache(const CacheSimConfig *config, int numTenants, int partition, const int *ways,
+                               unsigned long int interval, char *error, size_t errorLength);
+
+/* Simulate one access by tenant; returns CACHESIM_L1_HIT, CACHESIM_L2_HIT or CACHESIM_MEMORY */
+int accessSharedCache(SharedCache *shared, int tenant, unsigned long long int address, char operation);
+
+void freeSharedCache(SharedCache *shared);
+
+#endif
@@ -0,0 +1,500 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  synthetic.c
+ *
+ *    Description:  Synthetic workload generators
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include "synthetic.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* PCs of the generated accesses, one per stream, so PC-indexed analyses see distinct sites */
+#define PC_STREAM 0x400000
+#define PC_MATRIX_A 0x400010
+#define PC_MATRIX_B 0x400014
+#define PC_MATRIX_C_LOAD 0x400018
+#define PC_MATRIX_C_STORE 0x40001c
+
+static int parseSize(const char *value, unsigned long long int *result);
+static int setParameter(SyntheticGenerator *generator, const char *key, const char *value);
+static int setupGenerator(SyntheticGenerator *generator, char *error, size_t errorLength);
+static unsigned long long int nextRandom(SyntheticGenerator *generator);
+static double nextUniform(SyntheticGenerator *generator);
+static char chooseOperation(SyntheticGenerator *generator);
+static int nextMatrixAccess(SyntheticGenerator *generator, CacheSimAccess *access);
+
+
+SyntheticGenerator *createGenerator(const char *spec, char *error, size_t errorLength)
+{
+    SyntheticGenerator *generator = (SyntheticGenerator *) calloc(1, sizeof(SyntheticGenerator));
+    generator -> count = 0;
+    generator -> footprint = SYNTHETIC_DEFAULT_FOOTPRINT;
+    generator -> base = SYNTHETIC_DEFAULT_BASE;
+    generator -> alpha = 0.99;
+    generator -> n = SYNTHETIC_DEFAULT_MATRIX;
+    generator -> state = 1;
+
+    /* Pattern name, up to the first ':' */
+    char copy[256];
+    strncpy(copy, spec, sizeof(copy) - 1);
+    copy[sizeof(copy) - 1] = 0;
+    char *parameters = strchr(copy, ':');
+    if (parameters)
+    {
+        *parameters++ = 0;
+    }
+
+    if (!strcmp(copy, "seq"))
+    {
+        generator -> pattern = PATTERN_SEQUENTIAL;
+    }
+    else if (!strcmp(copy, "strided"))
+    {
+        generator -> pattern = PATTERN_SEQUENTIAL;
+        generator -> stride = 4096;
+    }
+    else if (!strcmp(copy, "random"))
+    {
+        generator -> pattern = PATTERN_RANDOM;
+    }
+    else if (!strcmp(copy, "zipf"))
+    {
+        generator -> pattern = PATTERN_ZIPF;
+    }
+    else if (!strcmp(copy, "chase"))
+    {
+        generator -> pattern = PATTERN_POINTER_CHASE;
+    }
+    else if (!strcmp(copy, "matmul"))
+    {
+        generator -> pattern = PATTERN_MATRIX_MULTIPLY;
+    }
+    else
+    {
+        snprintf(error, errorLength, "unknown synthetic pattern '%s'.", copy);
+        free(generator);
+        return 0;
+    }
+
+    /* Comma separated key=value pairs; the server builds generators from several threads */
+    char *position;
+    char *pair = parameters ? strtok_r(parameters, ",", &position) : 0;
+    while (pair)
+    {
+        char *value = strchr(pair, '=');
+        if (value == 0)
+        {
+            snprintf(error, errorLength, "synthetic parameter '%s' has no value.", pair);
+            free(generator);
+            return 0;
+        }
+        *value++ = 0;
+        if (setParameter(generator, pair, value))
+        {
+            snprintf(error, errorLength, "invalid synthetic parameter %s=%s.", pair, value);
+            free(generator);
+            return 0;
+        }
+        pair = strtok_r(0, ",", &position);
+    }
+
+    if (setupGenerator(generator, error, errorLength))
+    {
+        freeGenerator(generator);
+        return 0;
+    }
+
+    return generator;
+}
+
+
+int generateAccess(SyntheticGenerator *generator, CacheSimAccess *access)
+{
+    if (generator -> count && generator -> generated == generator -> count)
+    {
+        return 0;
+    }
+
+    access -> pc = PC_STREAM;
+    access -> size = generator -> size;
+
+    switch (generator -> pattern)
+    {
+        case PATTERN_SEQUENTIAL:
+            access -> address = generator -> base + generator -> offset;
+            access -> operation = chooseOperation(generator);
+            generator -> offset += generator -> stride;
+            /* Each pass over the footprint starts one element further into the stride */
+            if (generator -> offset + generator -> size > generator -> footprint)
+            {
+                generator -> lane = (generator -> lane + generator -> size) % generator -> stride;
+                generator -> offset = generator -> lane;
+            }
+            break;
+
+        case PATTERN_RANDOM:
+            access -> address = generator -> base +
+                                (nextRandom(generator) % (generator -> footprint / generator -> size)) * generator -> size;
+            access -> operation = chooseOperation(generator);
+            break;
+
+        case PATTERN_ZIPF:
+        {
+            /* Binary search the cumulative distribution for a uniform sample */
+            double u = nextUniform(generator);
+            unsigned long int low = 0, high = generator -> numObjects - 1;
+            while (low < high)
+            {
+                unsigned long int middle = (low + high) / 2;
+                if (generator -> cdf[middle] < u)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            access -> address = generator -> base + low * generator -> stride;
+            access -> operation = chooseOperation(generator);
+            break;
+        }
+
+        case PATTERN_POINTER_CHASE:
+            /* Load the pointer stored at the start of the current object */
+            access -> address = generator -> base + generator -> current * generator -> stride;
+            access -> operation = 'R';
+            generator -> current = generator -> next[generator -> current];
+            break;
+
+        case PATTERN_MATRIX_MULTIPLY:
+            if (!nextMatrixAccess(generator, access))
+            {
+                return 0;
+            }
+            break;
+    }
+
+    generator -> generated++;
+    return 1;
+}
+
+
+void freeGenerator(SyntheticGenerator *generator)
+{
+    free(generator -> cdf);
+    free(generator -> next);
+    free(generator);
+}
+
+
+static int parseSize(const char *value, unsigned long long int *result)
+{
+    /* A number with an optional K, M or G suffix; returns -1 if value is not one */
+    char *end;
+    unsigned long long int number = strtoull(value, &end, 0);
+    if (end == value)
+    {
+        return -1;
+    }
+    if (*end == 'K' || *end == 'k')
+    {
+        number <<= 10, end++;
+    }
+    else if (*end == 'M' || *end == 'm')
+    {
+        number <<= 20, end++;
+    }
+    else if (*end == 'G' || *end == 'g')
+    {
+        number <<= 30, end++;
+    }
+    if (*end)
+    {
+        return -1;
+    }
+    *result = number;
+    return 0;
+}
+
+
+static int setParameter(SyntheticGenerator *generator, const char *key, const char *value)
+{
+    /* Returns -1 for an unknown key or a malformed value */
+    unsigned long long int number;
+    char *end;
+
+    if (!strcmp(key, "writes") || !strcmp(key, "alpha"))
+    {
+        double real = strtod(value, &end);
+        if (end == value || *end)
+        {
+            return -1;
+        }
+        if (!strcmp(key, "writes"))
+        {
+            generator -> writes = real;
+        }
+        else
+        {
+            generator -> alpha = real;
+        }
+        return 0;
+    }
+
+    if (parseSize(value, &number))
+    {
+        return -1;
+    }
+    if (!strcmp(key, "count"))
+    {
+        generator -> count = number;
+    }
+    else if (!strcmp(key, "footprint"))
+    {
+        generator -> footprint = number;
+    }
+    else if (!strcmp(key, "stride"))
+    {
+        generator -> stride = number;
+    }
+    else if (!strcmp(key, "size"))
+    {
+        generator -> size = number;
+    }
+    else if (!strcmp(key, "base"))
+    {
+        generator -> base = number;
+    }
+    else if (!strcmp(key, "seed"))
+    {
+        /* xorshift needs a nonzero state */
+        generator -> state = number ? number : 1;
+    }
+    else if (!strcmp(key, "n"))
+    {
+        generator -> n = number;
+    }
+    else if (!strcmp(key, "block"))
+    {
+        generator -> block = number;
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+
+static int setupGenerator(SyntheticGenerator *generator, char *error, size_t errorLength)
+{
+    /* Fill in the defaults that depend on the pattern, check the parameters and build
+     * any tables; returns -1 with a message in error if the parameters are invalid */
+    int matrix = generator -> pattern == PATTERN_MATRIX_MULTIPLY;
+
+    if (generator -> size == 0)
+    {
+        generator -> size = matrix ? 8 : 4;
+    }
+    if (generator -> stride == 0)
+    {
+        generator -> stride = (generator -> pattern == PATTERN_SEQUENTIAL) ? generator -> size : 64;
+    }
+    /* The whole multiply unless a count is given */
+    if (generator -> count == 0 && !matrix)
+    {
+        generator -> count = SYNTHETIC_DEFAULT_COUNT;
+    }
+
+    if (generator -> size < 0 || generator -> footprint < generator -> size || generator -> footprint < generator -> stride)
+    {
+        snprintf(error, errorLength, "synthetic footprint must hold at least one element and one stride.");
+        return -1;
+    }
+    if (generator -> writes < 0 || generator -> writes > 1)
+    {
+        snprintf(error, errorLength, "synthetic write fraction must be between 0 and 1.");
+        return -1;
+    }
+    if (matrix && (generator -> n <= 0 || generator -> block < 0))
+    {
+        snprintf(error, errorLength, "synthetic matrix dimension and block must be positive.");
+        return -1;
+    }
+
+    if (generator -> pattern == PATTERN_ZIPF || generator -> pattern == PATTERN_POINTER_CHASE)
+    {
+        generator -> numObjects = generator -> footprint / generator -> stride;
+        if (generator -> numObjects > SYNTHETIC_MAX_OBJECTS)
+        {
+            snprintf(error, errorLength, "synthetic footprint holds more than %d objects.", SYNTHETIC_MAX_OBJECTS);
+            return -1;
+        }
+    }
+
+    unsigned long int i;
+    if (generator -> pattern == PATTERN_ZIPF)
+    {
+        /* Object i (from 0) has weight 1 / (i + 1)^alpha */
+        generator -> cdf = (double *) malloc(generator -> numObjects * sizeof(double));
+        double sum = 0;
+        for (i = 0; i < generator -> numObjects; i++)
+        {
+            sum += 1.0 / pow(i + 1, generator -> alpha);
+            generator -> cdf[i] = sum;
+        }
+        for (i = 0; i < generator -> numObjects; i++)
+        {
+            generator -> cdf[i] /= sum;
+        }
+    }
+    else if (generator -> pattern == PATTERN_POINTER_CHASE)
+    {
+        /* Sattolo's shuffle yields a single cycle through every object */
+        generator -> next = (unsigned int *) malloc(generator -> numObjects * sizeof(unsigned int));
+        for (i = 0; i < generator -> numObjects; i++)
+        {
+            generator -> next[i] = i;
+        }
+        for (i = generator -> numObjects - 1; i > 0; i--)
+        {
+            unsigned long int j = nextRandom(generator) % i;
+            unsigned int swap = generator -> next[i];
+            generator -> next[i] = generator -> next[j];
+            generator -> next[j] = swap;
+        }
+    }
+    else if (matrix && generator -> block == 0)
+    {
+        /* The naive loop nest is one tile covering the whole matrix */
+        generator -> block = generator -> n;
+    }
+
+    return 0;
+}
+
+
+static unsigned long long int nextRandom(SyntheticGenerator *generator)
+{
+    /* xorshift64* */
+    generator -> state ^= generator -> state >> 12;
+    generator -> state ^= generator -> state << 25;
+    generator -> state ^= generator -> state >> 27;
+    return generator -> state * 0x2545f4914f6cdd1dULL;
+}
+
+
+static double nextUniform(SyntheticGenerator *generator)
+{
+    /* Uniform in [0, 1) from the top 53 bits */
+    return (nextRandom(generator) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+static char chooseOperation(SyntheticGenerator *generator)
+{
+    if (generator -> writes > 0 && nextUniform(generator) < generator -> writes)
+    {
+        return 'W';
+    }
+    return 'R';
+}
+
+
+static int nextMatrixAccess(SyntheticGenerator *generator, CacheSimAccess *access)
+{
+    /* C = A * B with the loop nest
+     *
+     *   for ii, jj, kk in steps of block:
+     *     for i in ii.., j in jj..:
+     *       [load C[i][j] unless kk is the first tile]
+     *       for k in kk..: load A[i][k], load B[k][j]
+     *       store C[i][j]
+     *
+     * With block == n this is the naive ijk multiply. Returns 0 when it is done */
+    int n = generator -> n, block = generator -> block, size = generator -> size;
+    unsigned long long int a = generator -> base;
+    unsigned long long int b = a + (unsigned long long int) n * n * size;
+    unsigned long long int c = b + (unsigned long long int) n * n * size;
+    int kEnd = generator -> kk + block < n ? generator -> kk + block : n;
+
+    if (generator -> ii >= n)
+    {
+        return 0;
+    }
+
+    /* Step 0 starts an (i, j) element: load the partial sum from earlier tiles */
+    if (generator -> step == 0)
+    {
+        generator -> k = generator -> kk;
+        generator -> step = 1;
+        if (generator -> kk > 0)
+        {
+            access -> pc = PC_MATRIX_C_LOAD;
+            access -> operation = 'R';
+            access -> address = c + ((unsigned long long int) generator -> i * n + generator -> j) * size;
+            return 1;
+        }
+    }
+
+    /* Steps 1 and 2 load A[i][k] and B[k][j] */
+    if (generator -> k < kEnd)
+    {
+        access -> operation = 'R';
+        if (generator -> step == 1)
+        {
+            access -> pc = PC_MATRIX_A;
+            access -> address = a + ((unsigned long long int) generator -> i * n + generator -> k) * size;
+            generator -> step = 2;
+        }
+        else
+        {
+            access -> pc = PC_MATRIX_B;
+            access -> address = b + ((unsigned long long int) generator -> k * n + generator -> j) * size;
+            generator -> step = 1;
+            generator -> k++;
+        }
+        return 1;
+    }
+
+    /* Then store C[i][j] and move to the next element, tile and tile row */
+    access -> pc = PC_MATRIX_C_STORE;
+    access -> operation = 'W';
+    access -> address = c + ((unsigned long long int) generator -> i * n + generator -> j) * size;
+    generator -> step = 0;
+
+    int iEnd = generator -> ii + block < n ? generator -> ii + block : n;
+    int jEnd = generator -> jj + block < n ? generator -> jj + block : n;
+    if (++generator -> j == jEnd)
+    {
+        generator -> j = generator -> jj;
+        if (++generator -> i == iEnd)
+        {
+            generator -> kk += block;
+            if (generator -> kk >= n)
+            {
+                generator -> kk = 0;
+                generator -> jj += block;
+                if (generator -> jj >= n)
+                {
+                    generator -> jj = 0;
+                    generator -> ii += block;
+                }
+            }
+            generator -> i = generator -> ii;
+            generator -> j = generator -> jj;
+        }
+    }
+    return 1;
+}
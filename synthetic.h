@@ -0,0 +1,85 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  synthetic.h
+ *
+ *    Description:  Synthetic workload generators. A generator produces a parameterized
+ *                  access stream one access at a time, so the simulator can run on
+ *                  reproducible workloads of any length without a trace file.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include "libcachesim.h"
+#include <stddef.h>
+
+/* Access patterns */
+/* Scan the footprint stride bytes at a time, shifting by one element each pass */
+#define PATTERN_SEQUENTIAL 0
+/* Uniformly random elements of the footprint */
+#define PATTERN_RANDOM 1
+/* Objects of stride bytes chosen with Zipfian popularity */
+#define PATTERN_ZIPF 2
+/* Follow a single random cycle through objects of stride bytes */
+#define PATTERN_POINTER_CHASE 3
+/* C = A * B on n x n matrices, naive (ijk) or tiled in blocks */
+#define PATTERN_MATRIX_MULTIPLY 4
+
+/* Defaults for the spec parameters */
+#define SYNTHETIC_DEFAULT_COUNT 1000000
+#define SYNTHETIC_DEFAULT_FOOTPRINT (16 * 1024 * 1024)
+#define SYNTHETIC_DEFAULT_BASE 0x10000000
+#define SYNTHETIC_DEFAULT_MATRIX 64
+/* Limit on the tables built for zipf and chase */
+#define SYNTHETIC_MAX_OBJECTS (1 << 26)
+
+typedef struct syntheticGenerator SyntheticGenerator;
+struct syntheticGenerator
+{
+    int pattern;
+    /* Parameters; see createGenerator */
+    unsigned long long int count;
+    unsigned long long int footprint;
+    unsigned long long int stride;
+    unsigned long long int base;
+    int size;
+    double writes;
+    double alpha;
+    int n;
+    int block;
+    /* xorshift64* state */
+    unsigned long long int state;
+    /* Accesses generated so far */
+    unsigned long long int generated;
+    /* Sequential: the next offset, and the offset each pass starts at */
+    unsigned long long int offset;
+    unsigned long long int lane;
+    /* Zipf: cumulative probability of each object; chase: the next object of each object */
+    unsigned long int numObjects;
+    double *cdf;
+    unsigned int *next;
+    unsigned long int current;
+    /* Matrix multiply: loop indices, and the step within the innermost loop body */
+    int ii, jj, kk, i, j, k;
+    int step;
+};
+
+/* Parse spec, "pattern[:key=value,...]", and create a generator; returns NULL and
+ * writes a message into error if spec is invalid. Patterns are seq, strided, random,
+ * zipf, chase and matmul; keys are count, footprint, stride, size, base, writes,
+ * seed, alpha (zipf), n and block (matmul). Sizes take a K, M or G suffix */
+SyntheticGenerator *createGenerator(const char *spec, char *error, size_t errorLength);
+
+/* Produce the next access; returns 1 on success, 0 once count accesses have been generated */
+int generateAccess(SyntheticGenerator *generator, CacheSimAccess *access);
+
+void freeGenerator(SyntheticGenerator *generator);
+
+#endif
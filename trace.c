@@ -0,0 +1,1252 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  trace.c
+ *
+ *    Description:  Streaming trace readers and writers
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+/*
+ * Compressed trace layout (all fixed-width integers little-endian):
+ *
+ *   header    "CSTZ", u32 version, u32 records per block
+ *   blocks    u32 records, u32 dictionary entries, u32 payload bytes, payload
+ *   end       u32 0, u32 0, u32 0
+ *   metadata  u32 length, free-form text of that length (see setTraceMetadata)
+ *   index     u64 file offset, u64 first record; one pair per block
+ *   footer    u64 index offset, u64 blocks, u64 records, "CSTI"
+ *
+ * A payload starts with the block's PC dictionary (sorted PCs, each a varint delta
+ * from the previous one), followed by one record per access:
+ *
+ *   flags     bits 0-1 operation (0 R, 1 W, 2 other), bit 2 size present,
+ *             bit 3 same PC as the previous record
+ *   [op]      the operation character, if other
+ *   [pc]      dictionary index, or zigzag varint delta from the previous PC
+ *   address   zigzag varint delta from the previous address
+ *   [size]    varint
+ *
+ * Deltas restart from 0 at each block, so any block decodes on its own.
+ */
+
+/* fopencookie */
+#define _GNU_SOURCE
+
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define TRACE_MAGIC "CSTZ"
+#define TRACE_INDEX_MAGIC "CSTI"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_BYTES 12
+#define TRACE_BLOCK_HEADER_BYTES 12
+#define TRACE_FOOTER_BYTES 28
+/* Worst case encoded size of one record, and of one dictionary entry */
+#define TRACE_MAX_RECORD_BYTES 27
+#define TRACE_MAX_ENTRY_BYTES 10
+
+#define FLAG_SIZE 4
+#define FLAG_SAME_PC 8
+
+/* Readahead: a thread reads the trace file into a ring of buffers ahead of the parser,
+ * which reads them back through a FILE of its own. Each buffer is handed over by its
+ * full flag alone; a side only takes the lock to sleep when the ring is full (reader)
+ * or empty (parser), and the other side only takes it to wake a sleeper */
+typedef struct readaheadBuffer ReadaheadBuffer;
+struct readaheadBuffer
+{
+    char *data;
+    size_t length;
+    /* Set by the reader thread once data holds length bytes; cleared by the parser once
+     * it has used them. A full buffer of length 0 marks the end of the file */
+    atomic_int full;
+};
+
+typedef struct readahead Readahead;
+struct readahead
+{
+    FILE *source;
+    int ownsSource;
+    pthread_t thread;
+    ReadaheadBuffer buffers[TRACE_READAHEAD_BUFFERS];
+    /* The parser's position; only the parser touches these */
+    int readIndex;
+    size_t readOffset;
+    atomic_int stopping;
+    /* Slow path: whether each side is asleep, and what it sleeps on */
+    atomic_int readerWaiting;
+    atomic_int parserWaiting;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+static void *readAhead(void *argument);
+static ssize_t readReadahead(void *cookie, char *buffer, size_t size);
+static int closeReadahead(void *cookie);
+static void waitForBuffer(Readahead *readahead, ReadaheadBuffer *buffer, int full, atomic_int *waiting);
+static void wakeWaiter(Readahead *readahead, atomic_int *waiting);
+static int readLine(TraceReader *reader);
+static int parseTextRecord(TraceReader *reader);
+static int parseLackeyRecord(TraceReader *reader);
+static int parseCompressedRecord(TraceReader *reader);
+static int parseSyntheticRecord(TraceReader *reader);
+static int parseNextRecord(TraceReader *reader);
+static int loadCompressedBlock(TraceReader *reader);
+static TraceIndex *loadTraceIndex(int fd);
+static void flushTraceBlock(TraceWriter *writer);
+static size_t encodeTraceBlock(const CacheSimAccess *records, int numRecords, unsigned char *bytes, int *dictEntries);
+static int decodeTraceBytes(const unsigned char *bytes, size_t length, int numRecords, int dictEntries, CacheSimAccess *records);
+static int compareUnsigned(const void *a, const void *b);
+static void put32(unsigned char *p, unsigned int value);
+static void put64(unsigned char *p, unsigned long long int value);
+static unsigned int get32(const unsigned char *p);
+static unsigned long long int get64(const unsigned char *p);
+static size_t putVarint(unsigned char *p, unsigned long long int value);
+static const unsigned char *getVarint(const unsigned char *p, const unsigned char *end, unsigned long long int *value);
+
+
+TraceReader *openTrace(const char *path, int format)
+{
+    FILE *fp = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    /* fopen returns 0, the NULL pointer, on failure */
+    if (fp == 0)
+    {
+        return 0;
+    }
+
+    TraceReader *reader = (TraceReader *) calloc(1, sizeof(TraceReader));
+    reader -> fp = fp;
+    reader -> format = format;
+
+    /* No text or lackey line starts with 'C', so one byte of lookahead identifies
+     * a compressed trace, even on a pipe */
+    int c = getc(fp);
+    if (c == TRACE_MAGIC[0])
+    {
+        unsigned char header[TRACE_HEADER_BYTES];
+        header[0] = c;
+        if (fread(header + 1, 1, TRACE_HEADER_BYTES - 1, fp) != TRACE_HEADER_BYTES - 1 ||
+            memcmp(header, TRACE_MAGIC, 4) || get32(header + 4) != TRACE_VERSION)
+        {
+            closeTrace(reader);
+            return 0;
+        }
+        reader -> format = TRACE_COMPRESSED;
+        reader -> block = (CacheSimAccess *) malloc(TRACE_BLOCK_RECORDS * sizeof(CacheSimAccess));
+    }
+    else if (c != EOF)
+    {
+        ungetc(c, fp);
+    }
+
+    return reader;
+}
+
+
+TraceReader *openSyntheticTrace(SyntheticGenerator *generator)
+{
+    TraceReader *reader = (TraceReader *) calloc(1, sizeof(TraceReader));
+    reader -> format = TRACE_SYNTHETIC;
+    reader -> generator = generator;
+
+    return reader;
+}
+
+
+int seekTrace(TraceReader *reader, unsigned long long int record)
+{
+    /* Compressed files: jump straight to the block holding record */
+    if (reader -> format == TRACE_COMPRESSED && reader -> fp != stdin)
+    {
+        if (reader -> index == 0)
+        {
+            reader -> index = loadTraceIndex(fileno(reader -> fp));
+        }
+        if (reader -> index && record < reader -> index -> numRecords)
+        {
+            unsigned long int block = findTraceBlock(reader -> index, record);
+            fseeko(reader -> fp, reader -> index -> blockOffsets[block], SEEK_SET);
+            reader -> finished = 0;
+            if (loadCompressedBlock(reader) <= 0)
+            {
+                return -1;
+            }
+            reader -> blockPosition = record - reader -> index -> firstRecords[block];
+            reader -> records = record;
+            reader -> operationIndex = reader -> numOperations = 0;
+            return 0;
+        }
+        if (reader -> index && record == reader -> index -> numRecords)
+        {
+            /* Skipping every record leaves an empty remainder, as decoding them would */
+            reader -> finished = 1;
+            reader -> records = record;
+            reader -> operationIndex = reader -> numOperations = 0;
+            return 0;
+        }
+        if (reader -> index)
+        {
+            return -1;
+        }
+    }
+
+    /* Otherwise, decode and discard the records before it */
+    while (reader -> records < record)
+    {
+        if (!parseNextRecord(reader))
+        {
+            return -1;
+        }
+    }
+    reader -> operationIndex = reader -> numOperations = 0;
+
+    return 0;
+}
+
+
+int readTrace(TraceReader *reader, CacheSimAccess *access)
+{
+    /* Once every operation of the current record has been returned, decode the next one */
+    while (reader -> operationIndex == reader -> numOperations)
+    {
+        if (!parseNextRecord(reader))
+        {
+            return 0;
+        }
+    }
+
+    access -> pc = reader -> pc;
+    access -> operation = reader -> operations[reader -> operationIndex];
+    access -> address = reader -> cursor;
+    access -> size = reader -> size;
+
+    /* Without a size, or without splitting, the record is a single access */
+    if (reader -> splitBlockSize == 0 || reader -> size <= 1)
+    {
+        reader -> operationIndex++;
+        return 1;
+    }
+
+    /* Otherwise, return the part of the record within the current block */
+    unsigned long long int blockEnd = (reader -> cursor | (unsigned long long int) (reader -> splitBlockSize - 1));
+    if (blockEnd >= reader -> end)
+    {
+        access -> size = reader -> end - reader -> cursor + 1;
+        reader -> cursor = reader -> start;
+        reader -> operationIndex++;
+    }
+    else
+    {
+        access -> size = blockEnd - reader -> cursor + 1;
+        reader -> cursor = blockEnd + 1;
+    }
+
+    return 1;
+}
+
+
+int readTraceRun(TraceReader *reader, CacheSimAccess *access, unsigned long long int *repeats,
+                 unsigned long long int *writes)
+{
+    *repeats = *writes = 0;
+    if (reader -> hasPending)
+    {
+        *access = reader -> pending;
+        reader -> hasPending = 0;
+    }
+    else if (!readTrace(reader, access))
+    {
+        return 0;
+    }
+
+    /* Only reads and writes touch a block */
+    if (reader -> coalesceBlockSize == 0 || (access -> operation != 'R' && access -> operation != 'W'))
+    {
+        return 1;
+    }
+
+    /* Block sizes are powers of 2, so two addresses share a block when they differ only below it */
+    CacheSimAccess *next = &reader -> pending;
+    while (readTrace(reader, next))
+    {
+        if ((next -> operation != 'R' && next -> operation != 'W') ||
+            (next -> address ^ access -> address) >= (unsigned long long int) reader -> coalesceBlockSize)
+        {
+            reader -> hasPending = 1;
+            break;
+        }
+        (*repeats)++;
+        if (next -> operation == 'W')
+        {
+            (*writes)++;
+        }
+    }
+
+    return 1;
+}
+
+
+int startTraceReadahead(TraceReader *reader)
+{
+    /* Synthetic traces have no file to read ahead */
+    if (reader -> fp == 0)
+    {
+        return 0;
+    }
+
+    Readahead *readahead = (Readahead *) calloc(1, sizeof(Readahead));
+    readahead -> source = reader -> fp;
+    readahead -> ownsSource = (reader -> fp != stdin);
+    pthread_mutex_init(&readahead -> lock, 0);
+    pthread_cond_init(&readahead -> changed, 0);
+    int i;
+    for (i = 0; i < TRACE_READAHEAD_BUFFERS; i++)
+    {
+        readahead -> buffers[i].data = (char *) malloc(TRACE_READAHEAD_SIZE);
+        atomic_init(&readahead -> buffers[i].full, 0);
+    }
+
+    static const cookie_io_functions_t functions = { readReadahead, 0, 0, closeReadahead };
+    FILE *fp = fopencookie(readahead, "r", functions);
+    if (fp == 0 || pthread_create(&readahead -> thread, 0, readAhead, readahead))
+    {
+        if (fp)
+        {
+            /* closeReadahead must not join a thread that never started */
+            readahead -> source = 0;
+            fclose(fp);
+        }
+        return -1;
+    }
+
+    /* From here on only the thread reads the source, and closeTrace closes it through fp */
+    reader -> fp = fp;
+    return 0;
+}
+
+
+void closeTrace(TraceReader *reader)
+{
+    if (reader -> fp && reader -> fp != stdin)
+    {
+        fclose(reader -> fp);
+    }
+    if (reader -> index)
+    {
+        /* The index shares the reader's file descriptor, which is already closed */
+        reader -> index -> fd = -1;
+        closeTraceIndex(reader -> index);
+    }
+    if (reader -> generator)
+    {
+        freeGenerator(reader -> generator);
+    }
+    free(reader -> block);
+    free(reader -> buffer);
+    free(reader);
+}
+
+
+void writeTraceRecord(FILE *fp, const CacheSimAccess *access)
+{
+    if (access -> size)
+    {
+        fprintf(fp, "0x%08llx: %c 0x%08llx %d\n", access -> pc, access -> operation, access -> address, access -> size);
+    }
+    else
+    {
+        fprintf(fp, "0x%08llx: %c 0x%08llx\n", access -> pc, access -> operation, access -> address);
+    }
+}
+
+
+void writeTraceEnd(FILE *fp)
+{
+    fprintf(fp, "#eof\n");
+}
+
+
+TraceWriter *createTraceWriter(const char *path, int format)
+{
+    FILE *fp = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if (fp == 0)
+    {
+        return 0;
+    }
+
+    TraceWriter *writer = (TraceWriter *) calloc(1, sizeof(TraceWriter));
+    writer -> fp = fp;
+    writer -> format = format;
+
+    if (format == TRACE_COMPRESSED)
+    {
+        unsigned char header[TRACE_HEADER_BYTES];
+        memcpy(header, TRACE_MAGIC, 4);
+        put32(header + 4, TRACE_VERSION);
+        put32(header + 8, TRACE_BLOCK_RECORDS);
+        fwrite(header, 1, TRACE_HEADER_BYTES, fp);
+
+        writer -> offset = TRACE_HEADER_BYTES;
+        writer -> block = (CacheSimAccess *) malloc(TRACE_BLOCK_RECORDS * sizeof(CacheSimAccess));
+        writer -> buffer = (unsigned char *) malloc(TRACE_BLOCK_HEADER_BYTES +
+                                                    TRACE_BLOCK_RECORDS * (TRACE_MAX_RECORD_BYTES + TRACE_MAX_ENTRY_BYTES));
+    }
+
+    return writer;
+}
+
+
+void writeTrace(TraceWriter *writer, const CacheSimAccess *access)
+{
+    if (writer -> format != TRACE_COMPRESSED)
+    {
+        writeTraceRecord(writer -> fp, access);
+        return;
+    }
+
+    writer -> block[writer -> blockRecords++] = *access;
+    if (writer -> blockRecords == TRACE_BLOCK_RECORDS)
+    {
+        flushTraceBlock(writer);
+    }
+}
+
+
+void closeTraceWriter(TraceWriter *writer)
+{
+    if (writer -> format != TRACE_COMPRESSED)
+    {
+        if (writer -> metadata)
+        {
+            fprintf(writer -> fp, "#meta %s\n", writer -> metadata);
+        }
+        writeTraceEnd(writer -> fp);
+    }
+    else
+    {
+        if (writer -> blockRecords)
+        {
+            flushTraceBlock(writer);
+        }
+
+        /* End marker, metadata, index, footer */
+        unsigned char bytes[TRACE_FOOTER_BYTES];
+        size_t metadataLength = writer -> metadata ? strlen(writer -> metadata) : 0;
+        memset(bytes, 0, TRACE_BLOCK_HEADER_BYTES);
+        put32(bytes + TRACE_BLOCK_HEADER_BYTES, metadataLength);
+        fwrite(bytes, 1, TRACE_BLOCK_HEADER_BYTES + 4, writer -> fp);
+        fwrite(writer -> metadata, 1, metadataLength, writer -> fp);
+        unsigned long long int indexOffset = writer -> offset + TRACE_BLOCK_HEADER_BYTES + 4 + metadataLength;
+
+        unsigned long int i;
+        for (i = 0; i < writer -> numBlocks; i++)
+        {
+            put64(bytes, writer -> blockOffsets[i]);
+            put64(bytes + 8, writer -> firstRecords[i]);
+            fwrite(bytes, 1, 16, writer -> fp);
+        }
+
+        put64(bytes, indexOffset);
+        put64(bytes + 8, writer -> numBlocks);
+        put64(bytes + 16, writer -> records);
+        memcpy(bytes + 24, TRACE_INDEX_MAGIC, 4);
+        fwrite(bytes, 1, TRACE_FOOTER_BYTES, writer -> fp);
+    }
+
+    if (writer -> fp != stdout)
+    {
+        fclose(writer -> fp);
+    }
+    else
+    {
+        fflush(writer -> fp);
+    }
+    free(writer -> block);
+    free(writer -> buffer);
+    free(writer -> blockOffsets);
+    free(writer -> firstRecords);
+    free(writer -> metadata);
+    free(writer);
+}
+
+
+void setTraceMetadata(TraceWriter *writer, const char *metadata)
+{
+    free(writer -> metadata);
+    writer -> metadata = (char *) malloc(strlen(metadata) + 1);
+    strcpy(writer -> metadata, metadata);
+}
+
+
+TraceIndex *openTraceIndex(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    TraceIndex *index = loadTraceIndex(fd);
+    if (index == 0)
+    {
+        close(fd);
+    }
+
+    return index;
+}
+
+
+unsigned long int findTraceBlock(const TraceIndex *index, unsigned long long int record)
+{
+    /* Binary search for the last block starting at or before record */
+    unsigned long int low = 0, high = index -> numBlocks;
+    while (high - low > 1)
+    {
+        unsigned long int middle = low + (high - low) / 2;
+        if (index -> firstRecords[middle] <= record)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+int decodeTraceBlock(const TraceIndex *index, unsigned long int block, CacheSimAccess *records)
+{
+    /* pread leaves the file offset alone, so threads may share the descriptor */
+    unsigned char header[TRACE_BLOCK_HEADER_BYTES];
+    if (block >= index -> numBlocks ||
+        pread(index -> fd, header, TRACE_BLOCK_HEADER_BYTES, index -> blockOffsets[block]) != TRACE_BLOCK_HEADER_BYTES)
+    {
+        return -1;
+    }
+
+    int numRecords = get32(header);
+    int dictEntries = get32(header + 4);
+    size_t length = get32(header + 8);
+    if (numRecords > TRACE_BLOCK_RECORDS)
+    {
+        return -1;
+    }
+
+    unsigned char *bytes = (unsigned char *) malloc(length);
+    int result = -1;
+    if (pread(index -> fd, bytes, length, index -> blockOffsets[block] + TRACE_BLOCK_HEADER_BYTES) == (ssize_t) length)
+    {
+        result = decodeTraceBytes(bytes, length, numRecords, dictEntries, records);
+    }
+    free(bytes);
+
+    return result;
+}
+
+
+void closeTraceIndex(TraceIndex *index)
+{
+    if (index -> fd >= 0)
+    {
+        close(index -> fd);
+    }
+    free(index -> blockOffsets);
+    free(index -> firstRecords);
+    free(index);
+}
+
+
+static void *readAhead(void *argument)
+{
+    /* The reader thread: fill each buffer of the ring in turn, until the end of the file */
+    Readahead *readahead = (Readahead *) argument;
+    int writeIndex = 0;
+    while (1)
+    {
+        ReadaheadBuffer *buffer = &readahead -> buffers[writeIndex];
+        waitForBuffer(readahead, buffer, 0, &readahead -> readerWaiting);
+        if (atomic_load(&readahead -> stopping))
+        {
+            break;
+        }
+
+        buffer -> length = fread(buffer -> data, 1, TRACE_READAHEAD_SIZE, readahead -> source);
+        atomic_store_explicit(&buffer -> full, 1, memory_order_release);
+        wakeWaiter(readahead, &readahead -> parserWaiting);
+        if (buffer -> length == 0)
+        {
+            break;
+        }
+        writeIndex = (writeIndex + 1) % TRACE_READAHEAD_BUFFERS;
+    }
+    return 0;
+}
+
+
+static ssize_t readReadahead(void *cookie, char *data, size_t size)
+{
+    /* stdio's read function for the parser's FILE: copy out of the current buffer,
+     * handing it back to the reader thread once it has been used up */
+    Readahead *readahead = (Readahead *) cookie;
+    ReadaheadBuffer *buffer = &readahead -> buffers[readahead -> readIndex];
+    if (!atomic_load_explicit(&buffer -> full, memory_order_acquire))
+    {
+        waitForBuffer(readahead, buffer, 1, &readahead -> parserWaiting);
+    }
+    /* The end of the file stays full, so every later read sees it too */
+    if (buffer -> length == 0)
+    {
+        return 0;
+    }
+
+    size_t n = buffer -> length - readahead -> readOffset;
+    if (n > size)
+    {
+        n = size;
+    }
+    memcpy(data, buffer -> data + readahead -> readOffset, n);
+    readahead -> readOffset += n;
+
+    if (readahead -> readOffset == buffer -> length)
+    {
+        readahead -> readOffset = 0;
+        readahead -> readIndex = (readahead -> readIndex + 1) % TRACE_READAHEAD_BUFFERS;
+        atomic_store_explicit(&buffer -> full, 0, memory_order_release);
+        wakeWaiter(readahead, &readahead -> readerWaiting);
+    }
+    return n;
+}
+
+
+static int closeReadahead(void *cookie)
+{
+    /* Stop the reader thread, then close the source it was reading */
+    Readahead *readahead = (Readahead *) cookie;
+    if (readahead -> source)
+    {
+        atomic_store(&readahead -> stopping, 1);
+        pthread_mutex_lock(&readahead -> lock);
+        pthread_cond_broadcast(&readahead -> changed);
+        pthread_mutex_unlock(&readahead -> lock);
+        pthread_join(readahead -> thread, 0);
+        if (readahead -> ownsSource)
+        {
+            fclose(readahead -> source);
+        }
+    }
+
+    int i;
+    for (i = 0; i < TRACE_READAHEAD_BUFFERS; i++)
+    {
+        free(readahead -> buffers[i].data);
+    }
+    pthread_mutex_destroy(&readahead -> lock);
+    pthread_cond_destroy(&readahead -> changed);
+    free(readahead);
+    return 0;
+}
+
+
+static void waitForBuffer(Readahead *readahead, ReadaheadBuffer *buffer, int full, atomic_int *waiting)
+{
+    /* Sleep until buffer's full flag is full, or the readahead is stopping. The waiting
+     * flag is raised before the full flag is checked again, and the other side changes
+     * the full flag before it looks at waiting. A release store may pass a later load of
+     * another variable, so both sides put a full fence between their store and their
+     * load (here and in wakeWaiter); then at least one side sees the other's store, and
+     * the wakeup, sent under the lock, cannot be missed */
+    if (atomic_load_explicit(&buffer -> full, memory_order_acquire) == full)
+    {
+        return;
+    }
+    pthread_mutex_lock(&readahead -> lock);
+    atomic_store(waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (atomic_load(&buffer -> full) != full && !atomic_load(&readahead -> stopping))
+    {
+        pthread_cond_wait(&readahead -> changed, &readahead -> lock);
+    }
+    atomic_store(waiting, 0);
+    pthread_mutex_unlock(&readahead -> lock);
+}
+
+
+static void wakeWaiter(Readahead *readahead, atomic_int *waiting)
+{
+    /* Called just after a store to a full flag; keep that store ahead of the load of waiting */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(waiting))
+    {
+        pthread_mutex_lock(&readahead -> lock);
+        pthread_cond_broadcast(&readahead -> changed);
+        pthread_mutex_unlock(&readahead -> lock);
+    }
+}
+
+
+static int readLine(TraceReader *reader)
+{
+    /* Read one line into reader -> line; returns 0 at the end of the file */
+    if (fgets(reader -> line, sizeof(reader -> line), reader -> fp) == 0)
+    {
+        return 0;
+    }
+
+    /* Discard the rest of an over-long line */
+    if (!strchr(reader -> line, '\n'))
+    {
+        int c;
+        while ((c = getc(reader -> fp)) != EOF && c != '\n')
+        {
+        }
+    }
+
+    reader -> lines++;
+    return 1;
+}
+
+
+static int parseTextRecord(TraceReader *reader)
+{
+    /* Returns 1 if a record was decoded, 0 if the line holds none, -1 at the end of the trace */
+    if (!strncmp(reader -> line, "#eof", 4))
+    {
+        return -1;
+    }
+    if (!strncmp(reader -> line, "#meta ", 6))
+    {
+        strncpy(reader -> metadata, reader -> line + 6, sizeof(reader -> metadata) - 1);
+        reader -> metadata[strcspn(reader -> metadata, "\n")] = 0;
+        return 0;
+    }
+
+    unsigned long long int pc, address;
+    char operation;
+    int size = 0;
+    if (sscanf(reader -> line, "%llx: %c %llx %d", &pc, &operation, &address, &size) < 3)
+    {
+        return 0;
+    }
+
+    reader -> pc = pc;
+    reader -> start = address;
+    reader -> size = size;
+    reader -> operations[0] = operation;
+    reader -> numOperations = 1;
+
+    return 1;
+}
+
+
+static int parseLackeyRecord(TraceReader *reader)
+{
+    /* Lackey records look like "I  04001103,3", " L 1ffefffe98,8", " S ..." and " M ...";
+     * everything else (the "==pid==" banner, program output) is skipped */
+    char *p = reader -> line;
+    while (*p == ' ')
+    {
+        p++;
+    }
+
+    char kind = *p;
+    if ((kind != 'I' && kind != 'L' && kind != 'S' && kind != 'M') || p[1] != ' ')
+    {
+        return 0;
+    }
+
+    char *end;
+    unsigned long long int address = strtoull(p + 2, &end, 16);
+    if (end == p + 2 || *end != ',')
+    {
+        return 0;
+    }
+    int size = (int) strtol(end + 1, 0, 10);
+
+    /* Instruction fetches are not simulated; they supply the PC of the data accesses */
+    if (kind == 'I')
+    {
+        reader -> lastInstruction = address;
+        return 0;
+    }
+
+    reader -> pc = reader -> lastInstruction;
+    reader -> start = address;
+    reader -> size = size;
+    if (kind == 'L')
+    {
+        reader -> operations[0] = 'R';
+        reader -> numOperations = 1;
+    }
+    else if (kind == 'S')
+    {
+        reader -> operations[0] = 'W';
+        reader -> numOperations = 1;
+    }
+    /* A modify is a load followed by a store to the same location */
+    else
+    {
+        reader -> operations[0] = 'R';
+        reader -> operations[1] = 'W';
+        reader -> numOperations = 2;
+    }
+
+    return 1;
+}
+
+
+static int parseCompressedRecord(TraceReader *reader)
+{
+    /* Take the next record from the decoded block, decoding another block when it runs out */
+    if (reader -> blockPosition == reader -> blockRecords)
+    {
+        int result = loadCompressedBlock(reader);
+        if (result < 0)
+        {
+            fprintf(stderr, "Error: truncated or corrupt compressed trace.\n");
+        }
+        if (result <= 0)
+        {
+            return -1;
+        }
+    }
+
+    CacheSimAccess *record = &reader -> block[reader -> blockPosition++];
+    reader -> pc = record -> pc;
+    reader -> start = record -> address;
+    reader -> size = record -> size;
+    reader -> operations[0] = record -> operation;
+    reader -> numOperations = 1;
+
+    return 1;
+}
+
+
+static int parseSyntheticRecord(TraceReader *reader)
+{
+    CacheSimAccess access;
+    if (!generateAccess(reader -> generator, &access))
+    {
+        return -1;
+    }
+
+    reader -> pc = access.pc;
+    reader -> start = access.address;
+    reader -> size = access.size;
+    reader -> operations[0] = access.operation;
+    reader -> numOperations = 1;
+
+    return 1;
+}
+
+
+static int parseNextRecord(TraceReader *reader)
+{
+    /* Decode lines until one holds a record; returns 0 at the end of the trace */
+    int result = 0;
+    while (result == 0)
+    {
+        if (reader -> finished || (reader -> recordLimit && reader -> records == reader -> recordLimit))
+        {
+            reader -> finished = 1;
+            return 0;
+        }
+
+        if (reader -> format == TRACE_COMPRESSED)
+        {
+            result = parseCompressedRecord(reader);
+        }
+        else if (reader -> format == TRACE_SYNTHETIC)
+        {
+            result = parseSyntheticRecord(reader);
+        }
+        else if (!readLine(reader))
+        {
+            result = -1;
+        }
+        else
+        {
+            result = (reader -> format == TRACE_LACKEY) ? parseLackeyRecord(reader) : parseTextRecord(reader);
+        }
+
+        if (result < 0)
+        {
+            reader -> finished = 1;
+            return 0;
+        }
+    }
+
+    reader -> cursor = reader -> start;
+    reader -> end = reader -> start + (reader -> size > 1 ? reader -> size - 1 : 0);
+    reader -> operationIndex = 0;
+    reader -> records++;
+
+    return 1;
+}
+
+
+static int loadCompressedBlock(TraceReader *reader)
+{
+    /* Read and decode the block at the current file position; returns the number of
+     * records, 0 at the end marker, or -1 on a truncated or corrupt trace */
+    unsigned char header[TRACE_BLOCK_HEADER_BYTES];
+    if (fread(header, 1, TRACE_BLOCK_HEADER_BYTES, reader -> fp) != TRACE_BLOCK_HEADER_BYTES)
+    {
+        return -1;
+    }
+
+    int numRecords = get32(header);
+    int dictEntries = get32(header + 4);
+    size_t length = get32(header + 8);
+    /* After the end marker comes the metadata */
+    if (numRecords == 0)
+    {
+        unsigned char bytes[4];
+        if (fread(bytes, 1, 4, reader -> fp) == 4)
+        {
+            size_t metadataLength = get32(bytes);
+            size_t keep = metadataLength < sizeof(reader -> metadata) ? metadataLength : sizeof(reader -> metadata) - 1;
+            if (fread(reader -> metadata, 1, keep, reader -> fp) == keep)
+            {
+                reader -> metadata[keep] = 0;
+            }
+        }
+        return 0;
+    }
+    if (numRecords > TRACE_BLOCK_RECORDS ||
+        length > (size_t) TRACE_BLOCK_RECORDS * (TRACE_MAX_RECORD_BYTES + TRACE_MAX_ENTRY_BYTES))
+    {
+        return -1;
+    }
+
+    if (reader -> buffer == 0)
+    {
+        reader -> buffer = (unsigned char *) malloc((size_t) TRACE_BLOCK_RECORDS * (TRACE_MAX_RECORD_BYTES + TRACE_MAX_ENTRY_BYTES));
+    }
+    if (fread(reader -> buffer, 1, length, reader -> fp) != length)
+    {
+        return -1;
+    }
+
+    reader -> blockRecords = decodeTraceBytes(reader -> buffer, length, numRecords, dictEntries, reader -> block);
+    reader -> blockPosition = 0;
+    if (reader -> blockRecords < 0)
+    {
+        reader -> blockRecords = 0;
+        return -1;
+    }
+
+    return reader -> blockRecords;
+}
+
+
+static TraceIndex *loadTraceIndex(int fd)
+{
+    /* Read the footer, then the index it points to */
+    off_t fileSize = lseek(fd, 0, SEEK_END);
+    unsigned char footer[TRACE_FOOTER_BYTES];
+    if (fileSize < TRACE_HEADER_BYTES + TRACE_FOOTER_BYTES ||
+        pread(fd, footer, TRACE_FOOTER_BYTES, fileSize - TRACE_FOOTER_BYTES) != TRACE_FOOTER_BYTES ||
+        memcmp(footer + 24, TRACE_INDEX_MAGIC, 4))
+    {
+        return 0;
+    }
+
+    TraceIndex *index = (TraceIndex *) calloc(1, sizeof(TraceIndex));
+    unsigned long long int indexOffset = get64(footer);
+    index -> fd = fd;
+    index -> numBlocks = get64(footer + 8);
+    index -> numRecords = get64(footer + 16);
+    index -> blockOffsets = (unsigned long long int *) malloc((index -> numBlocks + 1) * sizeof(unsigned long long int));
+    index -> firstRecords = (unsigned long long int *) malloc((index -> numBlocks + 1) * sizeof(unsigned long long int));
+
+    size_t length = index -> numBlocks * 16;
+    unsigned char *bytes = (unsigned char *) malloc(length + 1);
+    if (indexOffset + length + TRACE_FOOTER_BYTES != (unsigned long long int) fileSize ||
+        pread(fd, bytes, length, indexOffset) != (ssize_t) length)
+    {
+        free(bytes);
+        index -> fd = -1;
+        closeTraceIndex(index);
+        return 0;
+    }
+
+    unsigned long int i;
+    for (i = 0; i < index -> numBlocks; i++)
+    {
+        index -> blockOffsets[i] = get64(bytes + 16 * i);
+        index -> firstRecords[i] = get64(bytes + 16 * i + 8);
+    }
+    free(bytes);
+
+    return index;
+}
+
+
+static void flushTraceBlock(TraceWriter *writer)
+{
+    /* Record where the block starts, then encode and write it */
+    if (writer -> numBlocks == writer -> maxBlocks)
+    {
+        writer -> maxBlocks = writer -> maxBlocks ? 2 * writer -> maxBlocks : 64;
+        writer -> blockOffsets = (unsigned long long int *) realloc(writer -> blockOffsets, writer -> maxBlocks * sizeof(unsigned long long int));
+        writer -> firstRecords = (unsigned long long int *) realloc(writer -> firstRecords, writer -> maxBlocks * sizeof(unsigned long long int));
+    }
+    writer -> blockOffsets[writer -> numBlocks] = writer -> offset;
+    writer -> firstRecords[writer -> numBlocks] = writer -> records;
+    writer -> numBlocks++;
+
+    int dictEntries;
+    size_t length = encodeTraceBlock(writer -> block, writer -> blockRecords, writer -> buffer + TRACE_BLOCK_HEADER_BYTES, &dictEntries);
+    put32(writer -> buffer, writer -> blockRecords);
+    put32(writer -> buffer + 4, dictEntries);
+    put32(writer -> buffer + 8, length);
+    fwrite(writer -> buffer, 1, TRACE_BLOCK_HEADER_BYTES + length, writer -> fp);
+
+    writer -> offset += TRACE_BLOCK_HEADER_BYTES + length;
+    writer -> records += writer -> blockRecords;
+    writer -> blockRecords = 0;
+}
+
+
+static size_t encodeTraceBlock(const CacheSimAccess *records, int numRecords, unsigned char *bytes, int *dictEntries)
+{
+    unsigned char *p = bytes;
+    int i;
+
+    /* Use a PC dictionary when the block's PCs repeat enough to pay for it */
+    unsigned long long int *dictionary = (unsigned long long int *) malloc(numRecords * sizeof(unsigned long long int));
+    int entries = 0;
+    for (i = 0; i < numRecords; i++)
+    {
+        dictionary[i] = records[i].pc;
+    }
+    qsort(dictionary, numRecords, sizeof(unsigned long long int), compareUnsigned);
+    for (i = 0; i < numRecords; i++)
+    {
+        if (i == 0 || dictionary[i] != dictionary[entries - 1])
+        {
+            dictionary[entries++] = dictionary[i];
+        }
+    }
+    if (entries > numRecords / 4)
+    {
+        entries = 0;
+    }
+
+    unsigned long long int previous = 0;
+    for (i = 0; i < entries; i++)
+    {
+        p += putVarint(p, dictionary[i] - previous);
+        previous = dictionary[i];
+    }
+
+    unsigned long long int previousPC = 0, previousAddress = 0;
+    for (i = 0; i < numRecords; i++)
+    {
+        const CacheSimAccess *record = &records[i];
+        unsigned char flags = record -> operation == 'R' ? 0 : record -> operation == 'W' ? 1 : 2;
+        if (record -> size)
+        {
+            flags |= FLAG_SIZE;
+        }
+        if (i > 0 && record -> pc == previousPC)
+        {
+            flags |= FLAG_SAME_PC;
+        }
+
+        *p++ = flags;
+        if ((flags & 3) == 2)
+        {
+            *p++ = record -> operation;
+        }
+        if (!(flags & FLAG_SAME_PC))
+        {
+            if (entries)
+            {
+                unsigned long long int *entry = (unsigned long long int *) bsearch(&record -> pc, dictionary, entries,
+                                                                                   sizeof(unsigned long long int), compareUnsigned);
+                p += putVarint(p, entry - dictionary);
+            }
+            else
+            {
+                long long int delta = (long long int) (record -> pc - previousPC);
+                p += putVarint(p, ((unsigned long long int) delta << 1) ^ (unsigned long long int) (delta >> 63));
+            }
+        }
+        long long int delta = (long long int) (record -> address - previousAddress);
+        p += putVarint(p, ((unsigned long long int) delta << 1) ^ (unsigned long long int) (delta >> 63));
+        if (record -> size)
+        {
+            p += putVarint(p, record -> size);
+        }
+
+        previousPC = record -> pc;
+        previousAddress = record -> address;
+    }
+
+    free(dictionary);
+    *dictEntries = entries;
+
+    return p - bytes;
+}
+
+
+static int decodeTraceBytes(const unsigned char *bytes, size_t length, int numRecords, int dictEntries, CacheSimAccess *records)
+{
+    /* Returns numRecords, or -1 if the payload is malformed */
+    const unsigned char *p = bytes, *end = bytes + length;
+    unsigned long long int value;
+    int i;
+
+    if (dictEntries < 0 || dictEntries > numRecords)
+    {
+        return -1;
+    }
+    unsigned long long int *dictionary = (unsigned long long int *) malloc((dictEntries + 1) * sizeof(unsigned long long int));
+    unsigned long long int previous = 0;
+    for (i = 0; i < dictEntries && p; i++)
+    {
+        p = getVarint(p, end, &value);
+        previous += value;
+        dictionary[i] = previous;
+    }
+
+    unsigned long long int pc = 0, address = 0;
+    for (i = 0; i < numRecords && p && p < end; i++)
+    {
+        unsigned char flags = *p++;
+        char operation = (flags & 3) == 0 ? 'R' : (flags & 3) == 1 ? 'W' : 0;
+        if (!operation)
+        {
+            if (p == end)
+            {
+                break;
+            }
+            operation = *p++;
+        }
+        if (!(flags & FLAG_SAME_PC))
+        {
+            p = getVarint(p, end, &value);
+            if (dictEntries)
+            {
+                if (value >= (unsigned long long int) dictEntries)
+                {
+                    break;
+                }
+                pc = dictionary[value];
+            }
+            else
+            {
+                pc += (value >> 1) ^ -(value & 1);
+            }
+        }
+        p = getVarint(p, end, &value);
+        address += (value >> 1) ^ -(value & 1);
+        value = 0;
+        if (flags & FLAG_SIZE)
+        {
+            p = getVarint(p, end, &value);
+        }
+
+        records[i].pc = pc;
+        records[i].address = address;
+        records[i].operation = operation;
+        records[i].size = (int) value;
+    }
+    free(dictionary);
+
+    return (i == numRecords && p) ? numRecords : -1;
+}
+
+
+static int compareUnsigned(const void *a, const void *b)
+{
+    unsigned long long int valueA = *(const unsigned long long int *) a;
+    unsigned long long int valueB = *(const unsigned long long int *) b;
+
+    return (valueA > valueB) - (valueA < valueB);
+}
+
+
+static void put32(unsigned char *p, unsigned int value)
+{
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        p[i] = value >> (8 * i);
+    }
+}
+
+
+static void put64(unsigned char *p, unsigned long long int value)
+{
+    int i;
+    for (i = 0; i < 8; i++)
+    {
+        p[i] = value >> (8 * i);
+    }
+}
+
+
+static unsigned int get32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+}
+
+
+static unsigned long long int get64(const unsigned char *p)
+{
+    return get32(p) | ((unsigned long long int) get32(p + 4) << 32);
+}
+
+
+static size_t putVarint(unsigned char *p, unsigned long long int value)
+{
+    /* LEB128: 7 bits per byte, high bit set on all but the last byte */
+    size_t length = 0;
+    while (value >= 0x80)
+    {
+        p[length++] = (value & 0x7f) | 0x80;
+        value = value >> 7;
+    }
+    p[length++] = value;
+
+    return length;
+}
+
+
+static const unsigned char *getVarint(const unsigned char *p, const unsigned char *end, unsigned long long int *value)
+{
+    /* Returns the byte after the varint, or NULL if it runs past end */
+    unsigned long long int result = 0;
+    int shift = 0;
+    while (p && p < end && shift < 64)
+    {
+        unsigned char byte = *p++;
+        result |= (unsigned long long int) (byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return p;
+        }
+        shift += 7;
+    }
+
+    *value = 0;
+    return 0;
+}
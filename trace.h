@@ -0,0 +1,166 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  trace.h
+ *
+ *    Description:  Streaming trace readers and writers. A TraceReader decodes one
+ *                  record at a time from a file or a pipe, so memory use does not
+ *                  depend on the length of the trace.
+ *
+ *        Version:  1.2
+ *        Created:  10/18/2026
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "libcachesim.h"
+#include "synthetic.h"
+#include <stdio.h>
+
+/* Trace formats */
+/* "0x<pc>: <R|W> 0x<address> [size]" lines, ending at "#eof" or end of file */
+#define TRACE_TEXT 0
+/* Raw output of valgrind --tool=lackey --trace-mem=yes */
+#define TRACE_LACKEY 1
+/* Compressed binary trace; see trace.c for the layout */
+#define TRACE_COMPRESSED 2
+/* Accesses produced in memory by a SyntheticGenerator; see openSyntheticTrace */
+#define TRACE_SYNTHETIC 3
+
+/* Readahead: the number and size of the buffers filled ahead of the parser */
+#define TRACE_READAHEAD_BUFFERS 4
+#define TRACE_READAHEAD_SIZE (1 << 20)
+
+/* Records per independently decodable block of a compressed trace */
+#define TRACE_BLOCK_RECORDS 65536
+
+/* The block index of a compressed trace. Blocks share no decoder state, so
+ * decodeTraceBlock may be called on different blocks from several threads at once */
+typedef struct traceIndex TraceIndex;
+struct traceIndex
+{
+    int fd;
+    unsigned long int numBlocks;
+    unsigned long long int numRecords;
+    /* File offset and number of the first record of each block */
+    unsigned long long int *blockOffsets;
+    unsigned long long int *firstRecords;
+};
+
+typedef struct traceWriter TraceWriter;
+struct traceWriter
+{
+    FILE *fp;
+    int format;
+    /* Compressed traces: the block being filled, and the offsets written so far */
+    CacheSimAccess *block;
+    int blockRecords;
+    unsigned char *buffer;
+    unsigned long long int offset;
+    unsigned long long int records;
+    unsigned long int numBlocks;
+    unsigned long int maxBlocks;
+    unsigned long long int *blockOffsets;
+    unsigned long long int *firstRecords;
+    char *metadata;
+};
+
+typedef struct traceReader TraceReader;
+struct traceReader
+{
+    FILE *fp;
+    int format;
+    /* If nonzero, an access spanning several blocks of this size is returned
+     * as one access per block */
+    int splitBlockSize;
+    /* If nonzero, readTraceRun folds consecutive reads and writes of one block of
+     * this size into a single access */
+    int coalesceBlockSize;
+    /* readTraceRun: the access read past the end of the last run, if any */
+    CacheSimAccess pending;
+    int hasPending;
+    /* The address of the last lackey instruction record, used as the PC of the
+     * data accesses that follow it */
+    unsigned long long int lastInstruction;
+    /* The record being returned: up to two operations (a lackey M is a read then
+     * a write), each split into one access per block */
+    unsigned long long int pc;
+    unsigned long long int start;
+    unsigned long long int end;
+    unsigned long long int cursor;
+    char operations[2];
+    int numOperations;
+    int operationIndex;
+    int size;
+    int finished;
+    /* Stop after this many records, if nonzero */
+    unsigned long long int recordLimit;
+    /* Compressed traces: the current decoded block, and the index if the file is seekable */
+    TraceIndex *index;
+    CacheSimAccess *block;
+    int blockRecords;
+    int blockPosition;
+    unsigned char *buffer;
+    /* Synthetic traces: the generator the records come from */
+    SyntheticGenerator *generator;
+    /* Metadata stored with the trace, available once the end of the trace is reached */
+    char metadata[256];
+    /* Statistics */
+    unsigned long long int lines;
+    unsigned long long int records;
+    char line[256];
+};
+
+/* Open path ("-" for standard input) for reading in the given format; returns NULL on failure.
+ * A compressed trace is recognized whatever format is given */
+TraceReader *openTrace(const char *path, int format);
+
+/* Read the records made by generator instead of a file; the reader frees the generator */
+TraceReader *openSyntheticTrace(SyntheticGenerator *generator);
+
+/* Skip to the given record; compressed traces use the index instead of decoding
+ * everything before it. Returns 0 on success (skipping every record leaves nothing
+ * to read), -1 if the trace is shorter */
+int seekTrace(TraceReader *reader, unsigned long long int record);
+
+/* Read the next access into access; returns 1 on success, 0 at the end of the trace */
+int readTrace(TraceReader *reader, CacheSimAccess *access);
+
+/* Read the next access, as readTrace, and count in repeats the reads and writes just
+ * after it that fall in the same block of coalesceBlockSize, and in writes how many
+ * of those are writes. The repeats are consumed, so every one of them hits the block
+ * the access leaves most recently used. Do not mix with readTrace on one reader */
+int readTraceRun(TraceReader *reader, CacheSimAccess *access, unsigned long long int *repeats,
+                 unsigned long long int *writes);
+
+/* Read the rest of the file on a background thread, a few large buffers ahead of
+ * readTrace, so disk and pipe latency overlap with simulation. Call it after any
+ * seekTrace; returns 0 on success, -1 if the thread could not be started */
+int startTraceReadahead(TraceReader *reader);
+
+void closeTrace(TraceReader *reader);
+
+/* Write one access as a text trace line, and the end-of-trace marker */
+void writeTraceRecord(FILE *fp, const CacheSimAccess *access);
+void writeTraceEnd(FILE *fp);
+
+/* Write a trace in the given format (TRACE_TEXT or TRACE_COMPRESSED) to path ("-" for standard output) */
+TraceWriter *createTraceWriter(const char *path, int format);
+void writeTrace(TraceWriter *writer, const CacheSimAccess *access);
+void closeTraceWriter(TraceWriter *writer);
+
+/* Store a line of text with the trace, written when the writer is closed */
+void setTraceMetadata(TraceWriter *writer, const char *metadata);
+
+/* Random access to the blocks of a compressed trace file */
+TraceIndex *openTraceIndex(const char *path);
+unsigned long int findTraceBlock(const TraceIndex *index, unsigned long long int record);
+/* Decode block into records (room for TRACE_BLOCK_RECORDS); returns the number of records, or -1 on error */
+int decodeTraceBlock(const TraceIndex *index, unsigned long int block, CacheSimAccess *records);
+void closeTraceIndex(TraceIndex *index);
+
+#endif